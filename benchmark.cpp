@@ -0,0 +1,513 @@
+// Drawing throughput benchmarks, on the headless platform so that no display is needed.
+// Every primitive is measured in each pixel mode, and the results are written as JSON:
+//
+//   g++ -std=c++17 -O2 benchmark.cpp -o benchmark -lpng -lpthread
+//   ./benchmark [results.json] [--deferred] [--gfx software|gl10|gl33]   (results.json defaults to benchmark.json)
+//
+// --deferred records the drawing and flushes it through the worker pool after every batch.
+// --gfx picks the renderer the frames are uploaded to and composited by, the OpenGL ones need a build with
+// -DOLC_HEADLESS_EGL (and -DOLC_GFX_OPENGL33 for gl33) linked with -lEGL -lGL, they then run
+// on whatever EGL provides without a display, e.g. Mesa's llvmpipe.
+// Resource packs are also saved and loaded through the temporary directory, and the upload
+// of the screen layer to the renderer is timed whole and with dirty tracking. Last, the CPU use
+// and input latency of running flat out, with a frame rate cap and idle are measured
+#define OLC_PLATFORM_HEADLESS
+#define OLC_PGE_APPLICATION
+#include "olcPixelGameEngine.h"
+#include <fstream>
+#include <iomanip>
+#include <filesystem>
+#include <random>
+#include <ctime>
+
+using namespace std::string_literals;
+
+namespace bench
+{
+	// Constants
+	constexpr int screenWidth = 256;
+	constexpr int screenHeight = 240;
+	constexpr float secondsPerCase = 0.25f;
+	constexpr int primitivesPerBatch = 256;
+	constexpr int decalsPerFrame = 100000;
+	constexpr int decalFrames = 10;
+	constexpr int packMegabytes = 64;
+	constexpr int packRepeats = 5;
+	constexpr int uploadSquare = 16;
+	constexpr int uploadFrames = 2 * int(olc::ProfileRing::nCapacity) + 1;
+	constexpr double pacingSeconds = 1.0;
+	constexpr float pacingFrameRate = 60.0f;
+
+	struct Case
+	{
+		std::string name;
+		// Draws primitive i of a batch
+		std::function<void(int i)> draw;
+	};
+
+	struct Result
+	{
+		std::string name;
+		std::string mode;
+		double primitivesPerSec = 0.0;
+		double pixelsPerSec = 0.0;
+		double nsPerPrimitive = 0.0;
+	};
+
+	struct PacingResult
+	{
+		std::string name;
+		double framesPerSec = 0.0;
+		double cpuPercent = 0.0;
+		float latencyMedianMs = 0.0f;
+		float latencyMaxMs = 0.0f;
+	};
+
+	class Benchmark : public olc::PixelGameEngine
+	{
+	public:
+		Benchmark(std::string output, bool deferred, std::string gfx) : outputFile(std::move(output)), useDeferred(deferred), gfxName(std::move(gfx))
+		{
+			sAppName = "benchmark"s;
+		}
+
+	public:
+		bool OnUserCreate() override
+		{
+			// A sprite with opaque, translucent and clear texels, so each mode has work to do
+			sprite = std::make_unique<olc::Sprite>(32, 32);
+			for (int y = 0; y < 32; y++)
+				for (int x = 0; x < 32; x++)
+				{
+					const uint8_t alpha = ((x / 4 + y / 4) % 3 == 0) ? 0 : ((x / 4 + y / 4) % 3 == 1 ? 128 : 255);
+					sprite->SetPixel(x, y, olc::Pixel(uint8_t(x * 8), uint8_t(y * 8), 128, alpha));
+				}
+			decal = std::make_unique<olc::Decal>(sprite.get());
+
+			BuildCases();
+			if (useDeferred) EnableDeferredDrawing(true);
+			return true;
+		}
+
+		bool OnUserUpdate(float fElapsedTime) override
+		{
+			if (frame == 0)
+			{
+				RunPrimitiveCases();
+				RunPackCases();
+			}
+			else if (frame <= decalFrames + 1)
+			{
+				// Frame times are measured from update to update, which spans compositing
+				// every decal drawn in the previous frame. Submitting them is timed on its own,
+				// the rest of the frame is the renderer
+				if (frame > 1) decalFrameTimes.push_back(fElapsedTime);
+				const auto start = std::chrono::steady_clock::now();
+				for (int i = 0; i < decalsPerFrame; i++)
+					DrawDecal({ float(i * 7 % (screenWidth - 8)), float(i * 13 % (screenHeight - 8)) }, decal.get(), { 0.25f, 0.25f });
+				if (frame < decalFrames + 1) decalSubmitTimes.push_back(std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count());
+			}
+			else if (frame < decalFrames + 2 + uploadFrames)
+				UploadFrame(frame - decalFrames - 2);
+			else if (!PacingFrame())
+			{
+				WriteResults();
+				return false;
+			}
+
+			frame++;
+			return true;
+		}
+
+		bool OnUserDestroy() override
+		{
+			StopInput();
+			return true;
+		}
+
+	private:
+		std::string outputFile;
+		bool useDeferred = false;
+		std::string gfxName;
+		int frame = 0;
+		std::unique_ptr<olc::Sprite> sprite;
+		std::unique_ptr<olc::Decal> decal;
+		std::vector<Case> cases;
+		std::vector<Result> results;
+		std::vector<float> decalFrameTimes;
+		std::vector<float> decalSubmitTimes;
+		std::vector<std::pair<std::string, double>> packResults;
+		float uploadFullSeconds = 0.0f;
+		float uploadDirtySeconds = 0.0f;
+		const std::vector<std::string> pacingRuns = { "unlimited"s, "capped"s, "idle"s };
+		std::vector<PacingResult> pacingResults;
+		int pacingRun = -1;
+		int pacingFrames = 0;
+		std::chrono::steady_clock::time_point pacingStart;
+		std::clock_t pacingCpuStart = 0;
+		std::vector<float> pacingLatencies;
+		std::thread inputThread;
+		std::atomic<bool> inputRunning{ false };
+		// Steady clock time of the input not yet seen by an update, 0 if none
+		std::atomic<int64_t> inputNanos{ 0 };
+		double packLz4Ratio = 0.0;
+		// Keeps the bytes read back from being optimised away
+		volatile uint64_t packChecksum = 0;
+		olc::Pixel colour = olc::WHITE;
+
+		// Scattered positions so primitives clip against every edge now and then
+		olc::vi2d Position(int i, int margin) const
+		{
+			return { (i * 37) % (screenWidth + margin) - margin / 2, (i * 53) % (screenHeight + margin) - margin / 2 };
+		}
+
+		void BuildCases()
+		{
+			cases.push_back({ "Draw"s, [this](int i) { Draw(Position(i, 0), colour); } });
+			cases.push_back({ "DrawLine"s, [this](int i) { DrawLine(Position(i, 64), Position(i * 7 + 3, 64), colour); } });
+			cases.push_back({ "DrawCircle"s, [this](int i) { DrawCircle(Position(i, 32), 4 + i % 28, colour); } });
+			cases.push_back({ "FillCircle"s, [this](int i) { FillCircle(Position(i, 32), 4 + i % 28, colour); } });
+			cases.push_back({ "FillRect"s, [this](int i) { FillRect(Position(i, 64), { 8 + i % 56, 8 + i % 40 }, colour); } });
+			cases.push_back({ "FillTriangle"s, [this](int i) { const olc::vi2d p = Position(i, 64); FillTriangle(p, p + olc::vi2d{ 48, 8 }, p + olc::vi2d{ 16, 40 }, colour); } });
+			cases.push_back({ "DrawSprite"s, [this](int i) { DrawSprite(Position(i, 32), sprite.get()); } });
+			cases.push_back({ "DrawSprite_scale2"s, [this](int i) { DrawSprite(Position(i, 64), sprite.get(), 2); } });
+			cases.push_back({ "DrawSprite_scale4"s, [this](int i) { DrawSprite(Position(i, 128), sprite.get(), 4); } });
+			cases.push_back({ "DrawSprite_flipped"s, [this](int i) { DrawSprite(Position(i, 32), sprite.get(), 1, olc::Sprite::HORIZ | olc::Sprite::VERT); } });
+			cases.push_back({ "DrawPartialSprite"s, [this](int i) { DrawPartialSprite(Position(i, 32), sprite.get(), { 4, 4 }, { 24, 20 }); } });
+			cases.push_back({ "DrawString"s, [this](int i) { DrawString(Position(i, 64), "Tic Tac Toe 0123"s, colour); } });
+			cases.push_back({ "DrawString_scale2"s, [this](int i) { DrawString(Position(i, 128), "Tic Tac Toe 0123"s, colour, 2); } });
+		}
+
+		// Frames that each draw one uploadSquare sized square, uploading the whole layer and
+		// then, with dirty tracking, only the area drawn to. Each run lasts as many frames as
+		// the profiler keeps, so the median of its upload phase covers just that run
+		void UploadFrame(int n)
+		{
+			const int runFrames = int(olc::ProfileRing::nCapacity);
+			auto UploadMedian = [this]() { return GetProfiler()->Percentile(olc::FrameProfiler::UPLOAD, 0.5f); };
+			if (n == 0) EnableProfiler(true);
+			if (n == runFrames)
+			{
+				uploadFullSeconds = UploadMedian();
+				EnableDirtyTracking(true);
+			}
+			if (n == 2 * runFrames)
+			{
+				uploadDirtySeconds = UploadMedian();
+				EnableDirtyTracking(false);
+				EnableProfiler(false);
+				return;
+			}
+			FillRect(Position(n * 5, 0), { uploadSquare, uploadSquare }, olc::Pixel(uint8_t(n), 120, 40));
+		}
+
+		// Runs of pacingSeconds flat out, capped to pacingFrameRate, then idle. Input arrives
+		// from another thread at random moments, as it would from the window system, and each
+		// run measures the process CPU time against the wall clock and how long input waits
+		// for the next update to see it
+		bool PacingFrame()
+		{
+			const auto now = std::chrono::steady_clock::now();
+			if (pacingRun < 0)
+			{
+				inputRunning = true;
+				inputThread = std::thread([this]() { InputLoop(); });
+				BeginPacingRun(0, now);
+			}
+
+			const int64_t input = inputNanos.exchange(0);
+			if (input != 0) pacingLatencies.push_back(float(now.time_since_epoch().count() - input) * 1e-6f);
+			pacingFrames++;
+
+			const double seconds = std::chrono::duration<double>(now - pacingStart).count();
+			if (seconds >= pacingSeconds)
+			{
+				std::sort(pacingLatencies.begin(), pacingLatencies.end());
+				PacingResult r;
+				r.name = pacingRuns[pacingRun];
+				r.framesPerSec = pacingFrames / seconds;
+				r.cpuPercent = 100.0 * double(std::clock() - pacingCpuStart) / CLOCKS_PER_SEC / seconds;
+				r.latencyMedianMs = pacingLatencies.empty() ? 0.0f : pacingLatencies[pacingLatencies.size() / 2];
+				r.latencyMaxMs = pacingLatencies.empty() ? 0.0f : pacingLatencies.back();
+				pacingResults.push_back(r);
+				std::cout << std::left << std::setw(12) << r.name << std::right << std::fixed << std::setprecision(1)
+					<< std::setw(10) << r.framesPerSec << " fps" << std::setw(8) << r.cpuPercent << "% CPU"
+					<< std::setprecision(3) << std::setw(10) << r.latencyMedianMs << " ms input latency (median), "
+					<< r.latencyMaxMs << " ms (max)" << std::endl;
+
+				if (pacingRun + 1 == int(pacingRuns.size()))
+				{
+					SetIdle(false);
+					StopInput();
+					return false;
+				}
+				BeginPacingRun(pacingRun + 1, now);
+			}
+
+			FillRect(Position(pacingFrames * 5, 0), { uploadSquare, uploadSquare }, olc::Pixel(uint8_t(pacingFrames), 120, 40));
+			return true;
+		}
+
+		void BeginPacingRun(int run, std::chrono::steady_clock::time_point now)
+		{
+			pacingRun = run;
+			SetFrameRateLimit(pacingRuns[run] == "capped"s ? pacingFrameRate : 0.0f);
+			SetIdle(pacingRuns[run] == "idle"s);
+			pacingStart = now;
+			pacingCpuStart = std::clock();
+			pacingFrames = 0;
+			pacingLatencies.clear();
+		}
+
+		// Input at 20 to 60ms intervals, a pending input is not replaced until it is seen
+		void InputLoop()
+		{
+			std::mt19937 rng(7);
+			std::uniform_int_distribution<int> interval(20000, 60000);
+			while (inputRunning)
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds(interval(rng)));
+				int64_t none = 0;
+				inputNanos.compare_exchange_strong(none, std::chrono::steady_clock::now().time_since_epoch().count());
+				WakeUp();
+			}
+		}
+
+		void StopInput()
+		{
+			inputRunning = false;
+			if (inputThread.joinable()) inputThread.join();
+		}
+
+		// Counts the pixels a batch writes in the current mode and colour, by drawing
+		// each primitive on its own over an opaque sentinel colour none of them produce.
+		// MASK and ALPHA leave clear texels alone, so they count fewer than NORMAL
+		uint64_t PixelsPerBatch(const Case& c)
+		{
+			const olc::Pixel sentinel(1, 2, 3, 255);
+			uint64_t pixels = 0;
+			olc::Sprite* target = GetDrawTarget();
+			for (int i = 0; i < primitivesPerBatch; i++)
+			{
+				Clear(sentinel);
+				c.draw(i);
+				FlushDrawing();
+				for (int p = 0; p < target->width * target->height; p++)
+					if (target->GetData()[p] != sentinel) pixels++;
+			}
+			return pixels;
+		}
+
+		void RunPrimitiveCases()
+		{
+			// MASK skips anything not opaque, so it is given an opaque colour, ALPHA a
+			// translucent one. CUSTOM stands for any user function, it just averages
+			const std::vector<std::pair<std::string, olc::Pixel>> modes = {
+				{ "NORMAL"s, olc::Pixel(200, 120, 40, 255) }, { "MASK"s, olc::Pixel(200, 120, 40, 255) },
+				{ "ALPHA"s, olc::Pixel(200, 120, 40, 160) }, { "CUSTOM"s, olc::Pixel(200, 120, 40, 255) } };
+
+			for (const auto& c : cases)
+			{
+				for (const auto& [modeName, modeColour] : modes)
+				{
+					colour = modeColour;
+					if (modeName == "CUSTOM"s)
+						SetPixelMode([](const int, const int, const olc::Pixel& s, const olc::Pixel& d)
+							{ return olc::Pixel((s.r + d.r) / 2, (s.g + d.g) / 2, (s.b + d.b) / 2); });
+					else
+						SetPixelMode(modeName == "NORMAL"s ? olc::Pixel::NORMAL : (modeName == "MASK"s ? olc::Pixel::MASK : olc::Pixel::ALPHA));
+
+					const uint64_t pixels = PixelsPerBatch(c);
+					Clear(olc::DARK_BLUE);
+					FlushDrawing();
+
+					// One untimed batch to warm the caches, then as many as fit in the time
+					auto RunBatch = [&]() { for (int i = 0; i < primitivesPerBatch; i++) c.draw(i); FlushDrawing(); };
+					RunBatch();
+
+					uint64_t batches = 0;
+					const auto start = std::chrono::steady_clock::now();
+					std::chrono::duration<double> elapsed{ 0.0 };
+					while (elapsed.count() < secondsPerCase)
+					{
+						RunBatch();
+						batches++;
+						elapsed = std::chrono::steady_clock::now() - start;
+					}
+
+					Result r;
+					r.name = c.name;
+					r.mode = modeName;
+					r.primitivesPerSec = double(batches * primitivesPerBatch) / elapsed.count();
+					r.pixelsPerSec = double(batches * pixels) / elapsed.count();
+					r.nsPerPrimitive = 1e9 / r.primitivesPerSec;
+					results.push_back(r);
+					std::cout << std::left << std::setw(20) << c.name << std::setw(8) << modeName
+						<< std::right << std::setw(14) << std::fixed << std::setprecision(0) << r.primitivesPerSec << " prim/s"
+						<< std::setw(16) << r.pixelsPerSec << " px/s" << std::endl;
+				}
+			}
+
+			SetPixelMode(olc::Pixel::NORMAL);
+			Clear(olc::BLACK);
+		}
+
+		// A pack of one incompressible file, saved and loaded with just the index
+		// scrambled then with the contents too, against memcpy and Scramble() of the
+		// same bytes. Then a file LZ4 can shrink, saved and loaded compressed. Loads
+		// read every byte, as mapped files are otherwise only read when used
+		void RunPackCases()
+		{
+			const size_t bytes = size_t(packMegabytes) << 20;
+			const std::filesystem::path dir = std::filesystem::temp_directory_path() / "olc_benchmark";
+			std::filesystem::create_directories(dir);
+			const std::string file = (dir / "payload.bin").string();
+			const std::string pack = (dir / "payload.pak").string();
+
+			std::vector<char> data(bytes), copy(bytes);
+			std::mt19937_64 rng(42);
+			for (size_t i = 0; i < bytes; i += 8) { const uint64_t r = rng(); std::memcpy(data.data() + i, &r, 8); }
+			std::ofstream(file, std::ios::binary).write(data.data(), bytes);
+
+			// Best of a few runs, in MB per second
+			auto Measure = [&](const std::string& name, const std::function<void()>& run)
+			{
+				double best = 0.0;
+				for (int r = 0; r < packRepeats; r++)
+				{
+					const auto start = std::chrono::steady_clock::now();
+					run();
+					const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+					best = std::max(best, double(packMegabytes) / elapsed.count());
+				}
+				packResults.push_back({ name, best });
+				std::cout << std::left << std::setw(28) << name << std::right << std::setw(14) << std::fixed << std::setprecision(0) << best << " MB/s" << std::endl;
+			};
+
+			auto Load = [&](olc::ResourcePack& rp, const std::string& name)
+			{
+				rp.LoadPack(pack, "benchmark key");
+				const olc::ResourceBuffer rb = rp.GetFileBuffer(name);
+				uint64_t checksum = 0;
+				for (uint32_t i = 0; i + 8 <= rb.nSize; i += 8) { uint64_t v; std::memcpy(&v, rb.pMemory + i, 8); checksum ^= v; }
+				packChecksum = checksum;
+			};
+
+			Measure("memcpy"s, [&]() { std::memcpy(copy.data(), data.data(), bytes); });
+			Measure("scramble"s, [&]() { olc::ResourcePack::Scramble(copy.data(), bytes, "benchmark key"); });
+			for (const bool scrambled : { false, true })
+			{
+				const std::string suffix = scrambled ? "_scrambled"s : ""s;
+				Measure("pack_save"s + suffix, [&]() { olc::ResourcePack rp; rp.AddFile(file); rp.SavePack(pack, "benchmark key", scrambled); });
+				Measure("pack_load"s + suffix, [&]() { olc::ResourcePack rp; Load(rp, file); });
+			}
+
+			// Each 64 bytes is half fresh, half a copy of bytes up to 4KB back, which
+			// LZ4 can find. Its MB per second are of the uncompressed size too
+			const std::string mixedFile = (dir / "mixed.bin").string();
+			for (size_t i = 0; i < bytes; i += 64)
+			{
+				for (size_t j = 0; j < 32; j += 8) { const uint64_t r = rng(); std::memcpy(data.data() + i + j, &r, 8); }
+				if (i < 4096)
+					for (size_t j = 32; j < 64; j += 8) { const uint64_t r = rng(); std::memcpy(data.data() + i + j, &r, 8); }
+				else
+					std::memcpy(data.data() + i + 32, data.data() + i - 64 - rng() % 4032, 32);
+			}
+			std::ofstream(mixedFile, std::ios::binary).write(data.data(), bytes);
+			Measure("pack_save_lz4"s, [&]() { olc::ResourcePack rp; rp.AddFile(mixedFile, true); rp.SavePack(pack, "benchmark key"); packLz4Ratio = double(rp.Stats().nFileBytes) / double(rp.Stats().nStoredBytes); });
+			Measure("pack_load_lz4"s, [&]() { olc::ResourcePack rp; Load(rp, mixedFile); });
+			std::cout << "LZ4 ratio " << std::setprecision(2) << packLz4Ratio << std::endl;
+
+			std::error_code ec;
+			std::filesystem::remove_all(dir, ec);
+		}
+
+		void WriteResults()
+		{
+			auto Median = [](std::vector<float>& v) { std::sort(v.begin(), v.end()); return v.empty() ? 0.0f : v[v.size() / 2]; };
+			const float decalMedian = Median(decalFrameTimes);
+			const float submitMedian = Median(decalSubmitTimes);
+			std::cout << decalsPerFrame << " decals on " << gfxName << ": " << std::setprecision(3) << decalMedian * 1000.0f
+				<< " ms per frame, " << submitMedian * 1000.0f << " ms of it submitting (median)" << std::endl;
+			std::cout << "Layer upload on " << gfxName << ": " << uploadFullSeconds * 1e6f << " us whole, " << uploadDirtySeconds * 1e6f
+				<< " us for a " << uploadSquare << "x" << uploadSquare << " dirty area (median)" << std::endl;
+
+#if defined(PGE_SIMD_AVX2)
+			const std::string simd = "avx2"s;
+#elif defined(PGE_SIMD_SSE2)
+			const std::string simd = "sse2"s;
+#else
+			const std::string simd = "none"s;
+#endif
+
+			std::ostringstream json;
+			json << std::setprecision(6) << std::defaultfloat;
+			json << "{\n  \"screen\": [" << screenWidth << ", " << screenHeight << "],\n";
+			json << "  \"simd\": \"" << simd << "\",\n";
+			json << "  \"deferred\": " << (useDeferred ? "true" : "false") << ",\n";
+			json << "  \"gfx\": \"" << gfxName << "\",\n";
+			json << "  \"primitives_per_batch\": " << primitivesPerBatch << ",\n";
+			json << "  \"results\": [\n";
+			for (size_t i = 0; i < results.size(); i++)
+			{
+				const Result& r = results[i];
+				json << "    { \"name\": \"" << r.name << "\", \"mode\": \"" << r.mode << "\", \"primitives_per_sec\": " << r.primitivesPerSec
+					<< ", \"pixels_per_sec\": " << r.pixelsPerSec << ", \"ns_per_primitive\": " << r.nsPerPrimitive << " }"
+					<< (i + 1 < results.size() ? ",\n" : "\n");
+			}
+			json << "  ],\n";
+			json << "  \"decals\": { \"count\": " << decalsPerFrame << ", \"frames\": " << decalFrameTimes.size()
+				<< ", \"median_frame_ms\": " << decalMedian * 1000.0f << ", \"median_submit_ms\": " << submitMedian * 1000.0f << " },\n";
+			json << "  \"upload\": { \"frames\": " << olc::ProfileRing::nCapacity << ", \"full_layer_us\": " << uploadFullSeconds * 1e6f
+				<< ", \"dirty_square\": " << uploadSquare << ", \"dirty_us\": " << uploadDirtySeconds * 1e6f << " },\n";
+			json << "  \"pacing\": [\n";
+			for (size_t i = 0; i < pacingResults.size(); i++)
+			{
+				const PacingResult& r = pacingResults[i];
+				json << "    { \"name\": \"" << r.name << "\", \"frames_per_sec\": " << r.framesPerSec << ", \"cpu_percent\": " << r.cpuPercent
+					<< ", \"input_latency_median_ms\": " << r.latencyMedianMs << ", \"input_latency_max_ms\": " << r.latencyMaxMs << " }"
+					<< (i + 1 < pacingResults.size() ? ",\n" : "\n");
+			}
+			json << "  ],\n";
+			json << "  \"packs\": { \"megabytes\": " << packMegabytes;
+			for (const auto& [name, mbPerSec] : packResults) json << ", \"" << name << "_mb_per_sec\": " << mbPerSec;
+			json << ", \"lz4_ratio\": " << packLz4Ratio;
+			json << " }\n}\n";
+
+			std::ofstream ofs(outputFile);
+			ofs << json.str();
+			std::cout << "Results written to " << outputFile << std::endl;
+		}
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	std::string output = "benchmark.json"s;
+	bool deferred = false;
+	std::string gfx = "software"s;
+	for (int i = 1; i < argc; i++)
+	{
+		if (argv[i] == "--deferred"s) deferred = true;
+		else if (argv[i] == "--gfx"s && i + 1 < argc) gfx = argv[++i];
+		else output = argv[i];
+	}
+
+	const std::map<std::string, olc::GfxBackend> backends = {
+		{ "software"s, olc::GfxBackend::SOFTWARE }, { "gl10"s, olc::GfxBackend::OPENGL10 }, { "gl33"s, olc::GfxBackend::OPENGL33 } };
+	if (backends.count(gfx) == 0)
+	{
+		std::cout << "Unknown --gfx " << gfx << ", expected software, gl10 or gl33" << std::endl;
+		return 1;
+	}
+
+	bench::Benchmark app(output, deferred, gfx);
+	// The pacing runs need the frame rate cap and idle waits to apply
+	app.GetHeadlessConfig().bWaitBetweenFrames = true;
+	if (app.Construct(bench::screenWidth, bench::screenHeight, 1, 1, false, false, false, backends.at(gfx)))
+		app.Start();
+	else
+		std::cout << "The " << gfx << " renderer is not available in this build" << std::endl;
+
+	return 0;
+};
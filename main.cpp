@@ -23,6 +23,7 @@ namespace game
 	constexpr bool playerStart = true;
 	constexpr bool useAi = true;
 	constexpr float aiThinkTime = 0.5f;
+	constexpr float frameRateLimit = 60.0f;
 
 	static_assert(!useAi || (boardWidth < 4), "AI and board size > 3 is disabled");
 
@@ -31,8 +32,13 @@ namespace game
 
 	// Typedefs
 	using Board = std::array<EPiece, boardWidth* boardWidth>;
-	using Sprite = std::shared_ptr<olc::Sprite>;
-	using Renderable = std::variant<std::monostate, olc::Pixel, Sprite>;
+	// An area of the atlas page, in pixels
+	struct AtlasSprite
+	{
+		olc::vf2d pos;
+		olc::vf2d size;
+	};
+	using Renderable = std::variant<std::monostate, olc::Pixel, AtlasSprite>;
 
 	struct WinningMove
 	{
@@ -66,9 +72,22 @@ namespace game
 	public:
 		bool OnUserCreate() override
 		{
-			PieceToRenderable.emplace(EPiece::None, olc::BLACK);
-			PieceToRenderable.emplace(EPiece::Cross, std::make_shared<olc::Sprite>("cross.png"s));
-			PieceToRenderable.emplace(EPiece::Cricle, std::make_shared<olc::Sprite>("circle.png"s));
+			// The pieces are decoded in the background, and drawn as plain colours
+			// until they are ready
+			for (const auto& file : { "cross.png"s, "circle.png"s })
+			{
+				pieceImages.emplace(file, assets.LoadSprite(file));
+			}
+#if defined(OLC_PLATFORM_HEADLESS)
+			// Time is simulated when headless, so wait for the images to keep runs repeatable
+			assets.WaitAll();
+#endif
+			BuildAtlas();
+
+			// Everything is drawn with decals, so the layer 0 sprite never changes
+			// and never needs uploading again
+			EnableDirtyTracking(true);
+			SetFrameRateLimit(frameRateLimit);
 
 			Reset();
 			return true;
@@ -77,6 +96,26 @@ namespace game
 		// Game loop
 		bool OnUserUpdate(float fElapsedTime) override
 		{
+			if (assets.Changed())
+			{
+				BuildAtlas();
+			}
+
+			if (GetKey(olc::Key::F1).bPressed)
+			{
+				showProfiler = !showProfiler;
+				EnableProfilerOverlay(showProfiler);
+			}
+
+			// The first press starts tracing, later ones write out what has been traced
+			if (GetKey(olc::Key::F2).bPressed)
+			{
+				if (GetTrace() == nullptr)
+					EnableTracing(true, "tictactoe_trace.json"s);
+				else
+					SaveTrace();
+			}
+
 			DrawBoard();
 			DrawBoardLines();
 			HighlightSelected(GetMousePos());
@@ -94,10 +133,10 @@ namespace game
 					DrawWinningLine(winningMove.value());
 				}
 
-				if(endMessage.length() > 0)
+				if (endMessage.length() > 0)
 				{
-					FillRect({ 0, 0 }, {boardWidth*tileSize, tileSize / 2}, olc::BLACK);
-					DrawString({ 0, tileSize/6 }, endMessage);
+					FillAtlasRect({ 0.0f, 0.0f }, { float(boardWidth * tileSize), float(tileSize / 2) }, olc::BLACK);
+					DrawStringDecal({ 0.0f, float(tileSize / 6) }, endMessage);
 				}
 
 				return true;
@@ -135,6 +174,22 @@ namespace game
 				std::cout << "Its a draw :S"s << std::endl;
 			}
 
+			// Nothing moves while waiting on the player, or on the ai once its think time is up,
+			// so let the engine sleep until there is input or the ai worker wakes it
+			const bool bComputerTurn = useAi && currentTurn == computerPiece;
+			SetIdle(!bGameEnded && (!bComputerTurn || aiThinkAccumulate > aiThinkTime));
+
+			return true;
+		}
+
+		// The platform is cleaned up once this returns, so nothing may call WakeUp() after it
+		bool OnUserDestroy() override
+		{
+			assets.Stop();
+			if (aiNextmMove.valid())
+			{
+				aiNextmMove.wait();
+			}
 			return true;
 		}
 
@@ -148,42 +203,173 @@ namespace game
 
 		bool bGameEnded = false;
 		float restartTimer = 0.0f;
+		bool showProfiler = false;
 		std::string endMessage;
 
 		std::optional<WinningMove> winningMove{};
 		std::map<EPiece, Renderable> PieceToRenderable;
 
+		olc::SpriteAtlas atlas;
+		std::unique_ptr<olc::Decal> atlasDecal;
+		AtlasSprite whitePatch{};
+
+		// Wakes the engine as each image is decoded, in case it is idle
+		olc::AssetManager assets{ 0, [this]() { WakeUp(); } };
+		std::map<std::string, olc::AssetManager::Handle> pieceImages;
+
 	private:
+		// Everything on screen is drawn from one texture, the pieces, the font, and
+		// a white patch that lines and rectangles are tinted from. Built again as
+		// each piece's image is decoded
+		void BuildAtlas()
+		{
+			for (auto it = pieceImages.begin(); it != pieceImages.end();)
+			{
+				if (assets.GetState(it->second) == olc::AssetManager::State::FAILED)
+				{
+					std::cout << "failed to load "s << it->first << std::endl;
+					it = pieceImages.erase(it);
+					continue;
+				}
+				++it;
+			}
+
+			// The decal and font must let go of the old page before it is cleared
+			SetFontDecal(nullptr);
+			atlasDecal.reset();
+
+			// If the pieces do not fit they are left out and drawn as plain colours. If
+			// even the font and white patch do not, there is no atlas, and text and
+			// rectangles fall back to the engine's own decals
+			if (TryBuildAtlas(true) || TryBuildAtlas(false))
+			{
+				atlasDecal = std::make_unique<olc::Decal>(atlas.GetPage(0));
+				SetFontDecal(atlasDecal.get(), atlas.GetRegion("font"s)->pos);
+
+				// Only the middle of the patch is sampled, so it never blends with its neighbours
+				whitePatch = { olc::vf2d(atlas.GetRegion("white"s)->pos) + olc::vf2d(1.0f, 1.0f), { 2.0f, 2.0f } };
+			}
+			else
+			{
+				std::cout << "failed to build atlas"s << std::endl;
+				atlas.Clear();
+			}
+
+			PieceToRenderable[EPiece::None] = olc::BLACK;
+			PieceToRenderable[EPiece::Cross] = AtlasPiece("cross.png"s, olc::RED);
+			PieceToRenderable[EPiece::Cricle] = AtlasPiece("circle.png"s, olc::BLUE);
+		}
+
+		// True if the atlas was built with at least the white patch and the font on one page
+		[[nodiscard]] bool TryBuildAtlas(bool withPieces)
+		{
+			olc::AtlasBuilder builder;
+			if (withPieces)
+			{
+				for (const auto& [file, handle] : pieceImages)
+				{
+					builder.Add(file, assets.GetSprite(handle));
+				}
+			}
+
+			olc::Sprite white(4, 4);
+			std::fill(white.GetData(), white.GetData() + 4 * 4, olc::WHITE);
+			builder.Add("white"s, &white);
+			builder.Add("font"s, GetFontSprite());
+			atlas.Clear();
+			return builder.Build(atlas) == olc::OK && atlas.PageCount() == 1
+				&& atlas.GetRegion("white"s) != nullptr && atlas.GetRegion("font"s) != nullptr;
+		}
+
+		// The piece's area of the atlas, or a plain colour if its image is not ready,
+		// failed to load or did not fit
+		[[nodiscard]] Renderable AtlasPiece(const std::string& file, olc::Pixel fallback) const
+		{
+			if (const auto region = atlas.GetRegion(file); region != nullptr && atlasDecal)
+			{
+				return AtlasSprite{ olc::vf2d(region->pos), olc::vf2d(region->size) };
+			}
+			return fallback;
+		}
+
+		void FillAtlasRect(const olc::vf2d& pos, const olc::vf2d& size, olc::Pixel col = olc::WHITE)
+		{
+			if (!atlasDecal)
+			{
+				FillRectDecal(pos, size, col);
+				return;
+			}
+			DrawPartialDecal(pos, size, atlasDecal.get(), whitePatch.pos, whitePatch.size, col);
+		}
+
+		void DrawRectDecal(const olc::vf2d& pos, const olc::vf2d& size, olc::Pixel col)
+		{
+			// Matches DrawRect, which includes both the start and end pixels
+			FillAtlasRect(pos, { size.x + 1.0f, 1.0f }, col);
+			FillAtlasRect({ pos.x, pos.y + size.y }, { size.x + 1.0f, 1.0f }, col);
+			FillAtlasRect(pos, { 1.0f, size.y + 1.0f }, col);
+			FillAtlasRect({ pos.x + size.x, pos.y }, { 1.0f, size.y + 1.0f }, col);
+		}
+
+		void DrawLineDecal(const olc::vi2d& start, const olc::vi2d& end, olc::Pixel col)
+		{
+			// A one pixel wide quad through the centres of the end pixels, extended by half
+			// a pixel either side so it covers the same pixels DrawLine would
+			const olc::vf2d a = olc::vf2d(start) + olc::vf2d(0.5f, 0.5f);
+			const olc::vf2d b = olc::vf2d(end) + olc::vf2d(0.5f, 0.5f);
+			olc::vf2d dir = b - a;
+			dir = (dir.mag2() > 0.0f) ? dir.norm() * 0.5f : olc::vf2d(0.5f, 0.0f);
+			const olc::vf2d side = dir.perp();
+
+			const std::array<olc::vf2d, 4> points = { a - dir - side, a - dir + side, b + dir + side, b + dir - side };
+			// Without an atlas the quad is untextured, like FillRectDecal
+			const olc::vf2d uv = atlasDecal ? (whitePatch.pos + whitePatch.size * 0.5f) * atlasDecal->vUVScale : olc::vf2d(0.0f, 0.0f);
+			const std::array<olc::vf2d, 4> uvs = { uv, uv, uv, uv };
+			const std::array<olc::Pixel, 4> cols = { col, col, col, col };
+			DrawExplicitDecal(atlasDecal.get(), points.data(), uvs.data(), cols.data());
+		}
+
 		void HighlightSelected(olc::vi2d mousePos)
 		{
-			const auto SelectedTile = WindowPosToBoardIdx(GetMousePos());
+			const auto SelectedTile = WindowPosToBoardIdx(mousePos);
 
 			const int x = SelectedTile / boardWidth;
 			const int y = SelectedTile % boardWidth;
 			const int squaresize = tileSize - 4;
-			
 
 			if (SelectedTile >= 0 && SelectedTile < board.size())
 			{
-
-				DrawRect({ x * tileSize+2, y * tileSize+2 },
-					{ squaresize, squaresize }, olc::YELLOW);
+				DrawRectDecal({ float(x * tileSize + 2), float(y * tileSize + 2) },
+					{ float(squaresize), float(squaresize) }, olc::YELLOW);
 			}
 		}
 
 		void StartAiThink()
 		{
 			aiThinkAccumulate = 0.0f;
-			aiNextmMove = std::async(std::launch::async, FindBestMove, board, computerPiece);
+			aiNextmMove = std::async(std::launch::async, [this, board = board]()
+			{
+				if (auto trace = GetTrace()) trace->SetThreadName("Ai"s);
+				const olc::ProfileScope profile(this, "AiSearch"s);
+				const int move = FindBestMove(board, computerPiece);
+				WakeUp();
+				return move;
+			});
 		}
 
 		void HandleAiTurn()
 		{
+			const olc::ProfileScope profile(this, "AiTurn"s);
 			if (aiThinkAccumulate > aiThinkTime)
 			{
-				auto status = aiNextmMove.wait_for(std::chrono::milliseconds(10));
+#if defined(OLC_PLATFORM_HEADLESS)
+				// Time is simulated when headless, so wait for the ai to keep runs repeatable
+				aiNextmMove.wait();
+#endif
+				auto status = aiNextmMove.wait_for(std::chrono::milliseconds(0));
 				if (status == std::future_status::timeout)
 				{
+					if (auto trace = GetTrace()) trace->Instant("WaitingForAi");
 					std::cout << "waiting for ai" << std::endl;
 					return;
 				}
@@ -225,11 +411,11 @@ namespace game
 		{
 			for (int x = 0; x < boardWidth; x++)
 			{
-				DrawLine({ 0, x * tileSize }, { ScreenWidth(), x * tileSize });
+				FillAtlasRect({ 0.0f, float(x * tileSize) }, { float(ScreenWidth()), 1.0f });
 			}
 			for (int y = 0; y < boardWidth; y++)
 			{
-				DrawLine({ y * tileSize, 0 }, { y * tileSize, ScreenHeight() });
+				FillAtlasRect({ float(y * tileSize), 0.0f }, { 1.0f, float(ScreenHeight()) });
 			}
 		}
 
@@ -260,39 +446,40 @@ namespace game
 			{
 				if (wm.direction.x != 0)
 				{
-					DrawLine({ start.x * tileSize , start.y * tileSize + tileSize / 2 }, 
+					DrawLineDecal({ start.x * tileSize , start.y * tileSize + tileSize / 2 }, 
 						{ end.x * tileSize , end.y * tileSize + tileSize / 2 }, olc::YELLOW);
 				}
 				if (wm.direction.y != 0)
 				{
-					DrawLine({ start.x * tileSize + tileSize / 2 , start.y * tileSize }, 
+					DrawLineDecal({ start.x * tileSize + tileSize / 2 , start.y * tileSize }, 
 						{ end.x * tileSize + tileSize / 2 , end.y * tileSize }, olc::YELLOW);
 				}
 
 			}
 			else if (wm.direction.x != wm.direction.y)
 			{
-				DrawLine({ start.x * tileSize , (start.y + 1) * tileSize }, { end.x * tileSize , (end.y + 1) * tileSize }, olc::YELLOW);
+				DrawLineDecal({ start.x * tileSize , (start.y + 1) * tileSize }, { end.x * tileSize , (end.y + 1) * tileSize }, olc::YELLOW);
 			}
 			else
 			{
-				DrawLine({ start.x * tileSize , start.y * tileSize }, { end.x * tileSize , end.y * tileSize }, olc::YELLOW);
+				DrawLineDecal({ start.x * tileSize , start.y * tileSize }, { end.x * tileSize , end.y * tileSize }, olc::YELLOW);
 			}
 		}
 
 		void DrawBoard()
 		{
+			const olc::ProfileScope profile(this, "DrawBoard"s);
 			for (int x = 0; x < boardWidth; x++)
 			{
 				for (int y = 0; y < boardWidth; y++)
 				{
 					const auto& renderable = PieceToRenderable.at(board.at(x * boardWidth + y));
+					const olc::vf2d pos = { float(x * tileSize), float(y * tileSize) };
 					const auto vistor = make_visitor
 					{
-						[=](olc::Pixel p) { FillRect({ x * tileSize, y * tileSize },
-										  { (x + 1) * tileSize, (y + 1) * tileSize },	p); },
+						[=](olc::Pixel p) { FillAtlasRect(pos, { float(tileSize), float(tileSize) }, p); },
 
-						[=](Sprite s) {DrawSprite(x * tileSize, y * tileSize, s.get(), 1, 0); },
+						[=](const AtlasSprite& s) { DrawPartialDecal(pos, atlasDecal.get(), s.pos, s.size); },
 
 						[](auto) {std::cout << "bad variant access"; },
 					};
@@ -459,11 +646,33 @@ namespace game
 	}
 }
 
-int main()
+int main(int argc, char* argv[])
 {
 	game::App app;
 	if (app.Construct(game::tileSize * game::boardWidth, game::tileSize * game::boardWidth, game::pixelSize, game::pixelSize))
+	{
+#if defined(OLC_PLATFORM_HEADLESS)
+		// A scripted game at a fixed frame rate, the player clicks every tile in turn, one
+		// a second. Frames are dumped if given a prefix, e.g. "golden/ttt_"
+		olc::HeadlessConfig& cfg = app.GetHeadlessConfig();
+		constexpr uint32_t secondFrames = uint32_t(game::frameRateLimit);
+		cfg.nFrames = (game::boardWidth * game::boardWidth + 4) * secondFrames;
+		cfg.fFrameTime = 1.0f / game::frameRateLimit;
+		if (argc > 1) cfg.sDumpPrefix = argv[1];
+		for (int i = 0; i < game::boardWidth * game::boardWidth; i++)
+		{
+			const uint32_t frame = uint32_t(i + 1) * secondFrames;
+			const int32_t x = (i % game::boardWidth) * game::tileSize + game::tileSize / 2;
+			const int32_t y = (i / game::boardWidth) * game::tileSize + game::tileSize / 2;
+			cfg.vecInput.push_back({ frame, olc::HeadlessInput::MOUSE_MOVE, x, y, 0 });
+			cfg.vecInput.push_back({ frame, olc::HeadlessInput::MOUSE_DOWN, 0, 0, 0 });
+			cfg.vecInput.push_back({ frame + 1, olc::HeadlessInput::MOUSE_UP, 0, 0, 0 });
+		}
+#else
+		UNUSED(argc); UNUSED(argv);
+#endif
 		app.Start();
+	}
 
 	return 0;
 };
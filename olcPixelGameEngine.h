@@ -260,6 +260,9 @@ int main()
 #include <algorithm>
 #include <array>
 #include <cstring>
+#include <cstddef>
+#include <mutex>
+#include <condition_variable>
 
 // O------------------------------------------------------------------------------O
 // | COMPILER CONFIGURATION ODDITIES                                              |
@@ -278,7 +281,7 @@ int main()
 	#endif
 #endif
 
-#if defined(__APPLE__)
+#if defined(__APPLE__) && !defined(OLC_PLATFORM_HEADLESS)
 	#define PGE_USE_CUSTOM_START
 #endif
 
@@ -301,10 +304,46 @@ int main()
 
 #define UNUSED(x) (void)(x)
 
-#if !defined(OLC_GFX_OPENGL33) && !defined(OLC_GFX_DIRECTX10)
+// OLC_PLATFORM_HEADLESS runs without a window or OpenGL, frames are drawn by
+// the software renderer into memory. See olc::HeadlessConfig
+//
+// With OLC_HEADLESS_EGL as well, the OpenGL renderers are kept and draw into an
+// offscreen framebuffer on an EGL context with no surface, e.g. Mesa's llvmpipe
+// with no display at all. Link with -lEGL -lGL
+#if defined(OLC_HEADLESS_EGL) && !defined(__linux__) && !defined(__FreeBSD__)
+	#undef OLC_HEADLESS_EGL
+#endif
+#if defined(OLC_PLATFORM_HEADLESS)
+	#if !defined(OLC_HEADLESS_EGL)
+		#undef OLC_GFX_OPENGL33
+	#endif
+	#undef OLC_GFX_DIRECTX10
+#endif
+
+// OpenGL 1.0 is always available, OLC_GFX_OPENGL33 adds the OpenGL 3.3
+// renderer and makes it the default, Construct() can pick either
+#if !defined(OLC_GFX_DIRECTX10) && (!defined(OLC_PLATFORM_HEADLESS) || defined(OLC_HEADLESS_EGL))
 	#define OLC_GFX_OPENGL10
 #endif
 
+// GLUT only provides a legacy context
+#if defined(OLC_GFX_OPENGL33) && defined(__APPLE__)
+	#undef OLC_GFX_OPENGL33
+#endif
+
+// Row kernels use SSE2 on any x86-64 target, and AVX2 where the compiler
+// has been allowed it (-mavx2, /arch:AVX2). OLC_NO_SIMD keeps them scalar
+#if !defined(OLC_NO_SIMD)
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define PGE_SIMD_SSE2
+		#include <emmintrin.h>
+	#endif
+	#if defined(__AVX2__)
+		#define PGE_SIMD_AVX2
+		#include <immintrin.h>
+	#endif
+#endif
+
 #if defined(_WIN32)
 	#if defined(OLC_IMAGE_STB)
 		#define PGE_ILOADER_STB
@@ -335,6 +374,7 @@ namespace olc
 	constexpr uint8_t  nDefaultAlpha = 0xFF;
 	constexpr uint32_t nDefaultPixel = (nDefaultAlpha << 24);
 	enum rcode { FAIL = 0, OK = 1, NO_FILE = -1 };
+	enum class GfxBackend { DEFAULT, OPENGL10, OPENGL33, DIRECTX10, SOFTWARE };
 
 	// O------------------------------------------------------------------------------O
 	// | olc::Pixel - Represents a 32-Bit RGBA colour                                 |
@@ -463,13 +503,45 @@ namespace olc
 
 
 
+	// O------------------------------------------------------------------------------O
+	// | olc::MappedFile - A whole file mapped into memory, read only on disk         |
+	// O------------------------------------------------------------------------------O
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		MappedFile(const olc::MappedFile&) = delete;
+		MappedFile& operator=(const olc::MappedFile&) = delete;
+		~MappedFile();
+		// The mapping is private, writes to Data() are copy on write and never
+		// reach the file
+		bool Open(const std::string& sFile);
+		void Close();
+		bool IsOpen() const;
+		uint8_t* Data() const;
+		size_t Size() const;
+	private:
+		uint8_t* pData = nullptr;
+		size_t nSize = 0;
+#if defined(_WIN32)
+		void* hFile = nullptr;
+		void* hMapping = nullptr;
+#endif
+	};
+
+
 	// O------------------------------------------------------------------------------O
 	// | olc::ResourcePack - A virtual scrambled filesystem to pack your assets into  |
 	// O------------------------------------------------------------------------------O
+	// One file of a pack, read in place from the pack's mapping, so only valid
+	// while the pack is loaded. Empty if the pack has no such file
 	struct ResourceBuffer : public std::streambuf
 	{
-		ResourceBuffer(std::ifstream& ifs, uint32_t offset, uint32_t size);
-		std::vector<char> vMemory;
+		ResourceBuffer(const char* data = nullptr, uint32_t size = 0);
+		// False for a file not in the pack, an empty file is still found
+		bool Found() const;
+		const char* pMemory = nullptr;
+		uint32_t nSize = 0;
 	};
 
 	class ResourcePack : public std::streambuf
@@ -477,16 +549,89 @@ namespace olc
 	public:
 		ResourcePack();
 		~ResourcePack();
-		bool AddFile(const std::string& sFile);
-		bool LoadPack(const std::string& sFile, const std::string& sKey);
-		bool SavePack(const std::string& sFile, const std::string& sKey);
+		// Compressed files are stored raw anyway if compression does not shrink them
+		bool AddFile(const std::string& sFile, bool bCompress = false);
+		// Compressed files are unpacked by nWorkers threads, 0 for one per core
+		bool LoadPack(const std::string& sFile, const std::string& sKey, uint32_t nWorkers = 0);
+		// bScrambleFiles scrambles the contents of files with the key too, not just
+		// the index. They are unscrambled in place a block at a time, the first time
+		// a file in the block is read, which copies the pages of the private mapping
+		bool SavePack(const std::string& sFile, const std::string& sKey, bool bScrambleFiles = false);
+		// Safe to call from several threads at once
 		ResourceBuffer GetFileBuffer(const std::string& sFile);
 		bool Loaded();
+		// XORs data with the key as packs are scrambled, from nPos bytes into the
+		// pack. Scrambling again restores the data
+		static void Scramble(char* data, size_t n, const std::string& sKey, uint64_t nPos = 0);
+
+		// What the last LoadPack() or SavePack() did
+		struct sPackStats
+		{
+			float fSeconds = 0.0f;
+			uint32_t nFiles = 0;
+			uint32_t nCompressed = 0;
+			uint64_t nFileBytes = 0;
+			uint64_t nStoredBytes = 0;
+		};
+		const sPackStats& Stats() const;
+
 	private:
-		struct sResourceFile { uint32_t nSize; uint32_t nOffset; };
+		// Set on the entry count of a directory index. Legacy packs, which list names
+		// and offsets instead, are laid out as a directory when loaded
+		static constexpr uint32_t nDirectoryIndex = 0x80000000;
+		// Compressed files are split into blocks of nBlockSize bytes, each stored as
+		// its compressed size then an LZ4 block. Blocks are also the most SavePack()
+		// holds in memory, and what LoadPack() shares out between workers
+		static constexpr uint32_t nBlockSize = 1 << 20;
+		enum Compression : uint32_t { RAW = 0, LZ4 = 1 };
+		enum DirectoryFlags : uint32_t { SCRAMBLED_FILES = 1 };
+		struct sResourceFile
+		{
+			uint32_t nSize = 0;
+			uint64_t nOffset = 0;
+			uint32_t nStoredSize = 0;
+			uint32_t nCompression = RAW;
+			bool bCompress = false;
+		};
+		// A directory is this header, the bucket table, the entries then their names.
+		// Entries are sorted by the hash of their name, and bucket b holds those whose
+		// hash starts with the bits of b, from pBuckets[b] up to pBuckets[b + 1]
+		struct sDirHeader { uint32_t nCount, nBucketBits, nNameBytes, nFlags; };
+		struct sDirEntry
+		{
+			uint32_t nHash, nName, nNameLength, nSize;
+			uint32_t nOffsetLo, nOffsetHi, nStoredSize, nCompression;
+		};
+		sPackStats stats;
+		// Files added to be saved
 		std::map<std::string, sResourceFile> mapFiles;
-		std::ifstream baseFile;
-		std::vector<char> scramble(const std::vector<char>& data, const std::string& key);
+		olc::MappedFile baseFile;
+		// The directory of the loaded pack, files are looked up in it where it lies.
+		// That is in the mapping, or for legacy packs here
+		std::vector<char> vDirectory;
+		const uint32_t* pBuckets = nullptr;
+		const sDirEntry* pEntries = nullptr;
+		const char* pNames = nullptr;
+		uint32_t nEntries = 0;
+		uint32_t nBucketBits = 0;
+		// Compressed files once unpacked by LoadPack(), by entry
+		std::vector<std::vector<char>> vUnpacked;
+		// Scrambled contents, from nScrambledFrom to the end of the pack, are
+		// unscrambled a block of nBlockSize bytes at a time when first read
+		std::vector<uint8_t> vKeystream;
+		std::unique_ptr<std::once_flag[]> pBlockUnscrambled;
+		uint64_t nScrambledFrom = 0;
+		void unscramble(uint64_t nOffset, uint64_t nSize);
+		const sDirEntry* find(const std::string& sFile) const;
+		bool opendirectory(const char* pDir, size_t nDir, uint64_t nFileSize);
+		void unload();
+		static std::vector<char> makedirectory(const std::map<std::string, sResourceFile>& files, uint32_t nFlags = 0);
+		static uint32_t hashname(const char* s, size_t n);
+		// The key repeated to at least 64 bytes, then 64 bytes more, so that it can be
+		// read 64 bytes at a time from anywhere in its first period
+		static std::vector<uint8_t> makekeystream(const std::string& key);
+		// XORs data in place with the repeated key, from nPos bytes into it
+		static void scramble(char* data, size_t n, const std::vector<uint8_t>& keystream, uint64_t nPos);
 		std::string makeposix(const std::string& path);
 	};
 
@@ -510,6 +655,8 @@ namespace olc
 		Sprite();
 		Sprite(const std::string& sImageFile, olc::ResourcePack* pack = nullptr);
 		Sprite(int32_t w, int32_t h);
+		// Refers to pData rather than copying it, the pixels must outlive the sprite
+		Sprite(int32_t w, int32_t h, Pixel* pData);
 		Sprite(const olc::Sprite&) = delete;
 		~Sprite();
 
@@ -536,6 +683,8 @@ namespace olc
 		olc::Sprite* Duplicate();
 		olc::Sprite* Duplicate(const olc::vi2d& vPos, const olc::vi2d& vSize);
 		Pixel* pColData = nullptr;
+		// False when pColData belongs to someone else, and so is never freed here
+		bool bOwnsData = true;
 		Mode modeSample = Mode::NORMAL;
 
 		static std::unique_ptr<olc::ImageLoader> loader;
@@ -575,11 +724,164 @@ namespace olc
 		std::unique_ptr<olc::Decal> pDecal = nullptr;
 	};
 
+	// O------------------------------------------------------------------------------O
+	// | olc::SpriteAtlas - Named regions of sprites, stored ready to map and draw    |
+	// O------------------------------------------------------------------------------O
+	// An atlas file holds pages of raw pixels, each starting on an nAlignment byte
+	// boundary, and named rectangles within them. LoadFromFile() maps the file and
+	// the pages refer to the mapped pixels, so nothing is decoded or copied. Fields
+	// are in the byte order of the machine that saved the file, as with .spr files:
+	//
+	//   Header  { char[4] "PGEA"; uint32 version, pages, regions, name bytes; uint32[3] 0 }
+	//   Pages   { uint32 width, height; uint64 offset of pixels }
+	//   Regions { uint32 name offset, name length, page; int32 x, y, w, h; uint32 0 }
+	//   Names   region names back to back, then each page's pixels
+	class SpriteAtlas
+	{
+	public:
+		struct Region
+		{
+			uint32_t nPage = 0;
+			olc::vi2d pos = { 0, 0 };
+			olc::vi2d size = { 0, 0 };
+		};
+
+		static constexpr uint32_t nVersion = 1;
+		static constexpr uint32_t nAlignment = 64;
+
+	public:
+		SpriteAtlas() = default;
+		SpriteAtlas(const olc::SpriteAtlas&) = delete;
+		~SpriteAtlas();
+
+	public:
+		olc::rcode LoadFromFile(const std::string& sFile);
+		olc::rcode SaveToFile(const std::string& sFile) const;
+		void Clear();
+		// Pages are numbered in the order they are added
+		uint32_t AddPage(std::unique_ptr<olc::Sprite> spr);
+		bool AddRegion(const std::string& sName, uint32_t nPage, const olc::vi2d& pos, const olc::vi2d& size);
+		// nullptr if there is no such page or region
+		olc::Sprite* GetPage(uint32_t nPage) const;
+		const Region* GetRegion(const std::string& sName) const;
+		uint32_t PageCount() const;
+		const std::map<std::string, Region>& Regions() const;
+
+	private:
+		olc::MappedFile file;
+		std::vector<std::unique_ptr<olc::Sprite>> vecPages;
+		std::map<std::string, Region> mapRegions;
+	};
+
+	// O------------------------------------------------------------------------------O
+	// | olc::AtlasBuilder - Packs many small sprites into one page of an atlas       |
+	// O------------------------------------------------------------------------------O
+	class AtlasBuilder
+	{
+	public:
+		// Sprites are kept nPadding clear pixels apart, so that sampling at the edge
+		// of one never picks up its neighbours. Pages are at most nMaxSize square
+		AtlasBuilder(int32_t nPadding = 1, int32_t nMaxSize = 4096);
+
+	public:
+		// Adds the whole of spr, or an area of it, under sName. The pixels are copied
+		// by Build(), so spr must live until then. False if there is nothing to add
+		bool Add(const std::string& sName, const olc::Sprite* spr);
+		bool Add(const std::string& sName, const olc::Sprite* spr, const olc::vi2d& vPos, const olc::vi2d& vSize);
+		// Packs everything added into a new page of atlas, the smallest power of two
+		// size found to fit, with a region for each sprite
+		olc::rcode Build(olc::SpriteAtlas& atlas);
+
+	private:
+		struct Entry { std::string sName; const olc::Sprite* spr; olc::vi2d vSource, vSize, vPlaced; };
+		std::vector<Entry> vecEntries;
+		int32_t nPadding;
+		int32_t nMaxSize;
+		bool Pack(int32_t nWidth, int32_t nHeight);
+	};
+
+
+	// O------------------------------------------------------------------------------O
+	// | olc::AssetManager - Decodes images on worker threads, never waiting for them |
+	// O------------------------------------------------------------------------------O
+	class AssetManager
+	{
+	public:
+		// Images are decoded by nWorkers threads, 0 for one per core. OnReady is
+		// called on a worker as each image finishes, whether it loaded or not
+		AssetManager(uint32_t nWorkers = 0, std::function<void()> OnReady = nullptr);
+		AssetManager(const olc::AssetManager&) = delete;
+		AssetManager& operator=(const olc::AssetManager&) = delete;
+		// Stops the workers, see Stop()
+		~AssetManager();
+
+	public:
+		enum class State { LOADING, READY, FAILED };
+		using Handle = uint32_t;
+		// Queues the image and returns at once. It is decoded by the ImageLoader
+		// as LoadFromFile() would, so the pack must outlive the load
+		Handle LoadSprite(const std::string& sImageFile, olc::ResourcePack* pack = nullptr);
+		State GetState(Handle h) const;
+		// The decoded sprite, or nullptr until READY
+		olc::Sprite* GetSprite(Handle h) const;
+		// True if images have finished since it was last called, so that whatever
+		// is built from them can be built again
+		bool Changed();
+		// Blocks until nothing is loading
+		void WaitAll();
+		// Images still queued are abandoned as FAILED and any being decoded are
+		// finished first. OnReady is never called once it returns, nor is anything
+		// loaded after it
+		void Stop();
+
+	private:
+		struct sAsset
+		{
+			std::string sFile;
+			olc::ResourcePack* pack = nullptr;
+			std::unique_ptr<olc::Sprite> sprite;
+			std::atomic<State> state{ State::LOADING };
+		};
+		// Handles index this, assets are never moved so workers can hold on to them
+		std::vector<std::unique_ptr<sAsset>> vecAssets;
+		std::list<sAsset*> listQueued;
+		std::vector<std::thread> vecWorkers;
+		std::function<void()> funcOnReady;
+		std::mutex muxQueue;
+		std::condition_variable cvQueued, cvIdle;
+		uint32_t nLoading = 0;
+		bool bQuit = false;
+		std::atomic<bool> bChanged{ false };
+		void Worker();
+	};
+
 
 	// O------------------------------------------------------------------------------O
 	// | Auxilliary components internal to engine                                     |
 	// O------------------------------------------------------------------------------O
 
+	// Kernels that write a row of n pixels in one go, shared by the drawing routines
+	namespace span
+	{
+		// Sets every pixel to p
+		void Fill(olc::Pixel* dst, int32_t n, olc::Pixel p);
+		// Blends p over every pixel, as Pixel::ALPHA mode does
+		void FillBlend(olc::Pixel* dst, int32_t n, olc::Pixel p, float fBlend);
+		// Per pixel versions of the NORMAL, MASK and ALPHA modes, reading from src
+		void Copy(olc::Pixel* dst, const olc::Pixel* src, int32_t n);
+		void Mask(olc::Pixel* dst, const olc::Pixel* src, int32_t n);
+		void Blend(olc::Pixel* dst, const olc::Pixel* src, int32_t n, float fBlend);
+	}
+
+	// Compression of resource pack files, in the LZ4 block format
+	namespace lz4
+	{
+		// Replaces vDst with the compressed form of the n bytes at pSrc
+		void Compress(const uint8_t* pSrc, size_t n, std::vector<uint8_t>& vDst);
+		// False unless pSrc holds a valid block that unpacks to exactly nDst bytes
+		bool Decompress(const uint8_t* pSrc, size_t nSrc, uint8_t* pDst, size_t nDst);
+	}
+
 	struct DecalInstance
 	{
 		olc::Decal* decal = nullptr;
@@ -597,19 +899,100 @@ namespace olc
 		olc::Decal* decal = nullptr;
 	};
 
+	// A string drawn by DrawStringDecal(), kept as one instance until the renderer
+	// expands it into a quad per glyph while packing the layer's decals
+	struct DecalGlyphRun
+	{
+		olc::Decal* font = nullptr;
+		// Of the font sheet within font, in texels
+		olc::vf2d vFontOffset = { 0.0f, 0.0f };
+		// Drawn just before the layer's vecDecalInstance[nBefore]
+		size_t nBefore = 0;
+		// As passed to DrawStringDecal(), in screen pixels
+		olc::vf2d pos, scale;
+		olc::vf2d vInvScreenSize;
+		olc::Pixel tint = olc::WHITE;
+		// The text is nLength characters of the layer's sGlyphText from nText
+		uint32_t nText = 0, nLength = 0;
+		// Characters with a glyph, each of which becomes a quad
+		uint32_t nGlyphs = 0;
+	};
+
 	struct LayerDesc
 	{
 		olc::vf2d vOffset = { 0, 0 };
 		olc::vf2d vScale = { 1, 1 };
 		bool bShow = false;
 		bool bUpdate = false;
+		olc::vi2d vDirtyMin = { INT32_MAX, INT32_MAX };
+		olc::vi2d vDirtyMax = { INT32_MIN, INT32_MIN };
 		olc::Sprite* pDrawTarget = nullptr;
 		uint32_t nResID = 0;
 		std::vector<DecalInstance> vecDecalInstance;
+		std::vector<DecalGlyphRun> vecGlyphRuns;
+		std::string sGlyphText;
 		olc::Pixel tint = olc::WHITE;
 		std::function<void()> funcHook = nullptr;
 	};
 
+	// Number of quads the decals of a layer make, with text counted by the glyph
+	inline size_t DecalCount(const olc::LayerDesc& layer)
+	{
+		size_t n = layer.vecDecalInstance.size();
+		for (const auto& run : layer.vecGlyphRuns) n += run.nGlyphs;
+		return n;
+	}
+
+	// Calls f(const olc::DecalInstance&) for each decal of a layer in the order they
+	// were drawn, with text expanded into a decal per glyph, just as DrawPartialDecal()
+	// would have made them
+	template<typename F> void ForEachDecal(const olc::LayerDesc& layer, F&& f)
+	{
+		size_t r = 0;
+		auto Glyphs = [&](size_t nBefore)
+		{
+			for (; r < layer.vecGlyphRuns.size() && layer.vecGlyphRuns[r].nBefore <= nBefore; r++)
+			{
+				const olc::DecalGlyphRun& run = layer.vecGlyphRuns[r];
+				olc::DecalInstance di; di.decal = run.font; di.tint[0] = run.tint;
+				olc::vf2d spos = { 0.0f, 0.0f };
+				for (uint32_t n = 0; n < run.nLength; n++)
+				{
+					const char c = layer.sGlyphText[run.nText + n];
+					if (c == '\n')
+					{
+						spos.x = 0; spos.y += 8.0f * run.scale.y;
+						continue;
+					}
+
+					const int32_t g = int32_t(c) - 32;
+					if (g >= 0 && g < 96)
+					{
+						const olc::vf2d p = run.pos + spos;
+						const olc::vf2d vPos = { (p.x * run.vInvScreenSize.x) * 2.0f - 1.0f, ((p.y * run.vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
+						const olc::vf2d vDim = { vPos.x + (2.0f * 8.0f * run.vInvScreenSize.x) * run.scale.x, vPos.y - (2.0f * 8.0f * run.vInvScreenSize.y) * run.scale.y };
+						di.pos[0] = { vPos.x, vPos.y }; di.pos[1] = { vPos.x, vDim.y };
+						di.pos[2] = { vDim.x, vDim.y }; di.pos[3] = { vDim.x, vPos.y };
+
+						const olc::vf2d uvtl = (olc::vf2d(float(g % 16) * 8.0f, float(g / 16) * 8.0f) + run.vFontOffset) * run.font->vUVScale;
+						const olc::vf2d uvbr = uvtl + (olc::vf2d(8.0f, 8.0f) * run.font->vUVScale);
+						di.uv[0] = { uvtl.x, uvtl.y }; di.uv[1] = { uvtl.x, uvbr.y };
+						di.uv[2] = { uvbr.x, uvbr.y }; di.uv[3] = { uvbr.x, uvtl.y };
+						f(di);
+					}
+					spos.x += 8.0f * run.scale.x;
+				}
+			}
+		};
+
+		for (size_t i = 0; i < layer.vecDecalInstance.size(); i++)
+		{
+			Glyphs(i);
+			f(layer.vecDecalInstance[i]);
+		}
+		Glyphs(SIZE_MAX);
+	}
+
 	class Renderer
 	{
 	public:
@@ -621,12 +1004,16 @@ namespace olc
 		virtual void       PrepareDrawing() = 0;
 		virtual void       DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) = 0;
 		virtual void       DrawDecalQuad(const olc::DecalInstance& decal) = 0;
+		virtual void       DrawDecalQuads(const olc::LayerDesc& layer) { olc::ForEachDecal(layer, [&](const olc::DecalInstance& decal) { DrawDecalQuad(decal); }); }
 		virtual uint32_t   CreateTexture(const uint32_t width, const uint32_t height) = 0;
 		virtual void       UpdateTexture(uint32_t id, olc::Sprite* spr) = 0;
+		virtual void       UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) { UNUSED(pos); UNUSED(size); UpdateTexture(id, spr); }
 		virtual uint32_t   DeleteTexture(const uint32_t id) = 0;
 		virtual void       ApplyTexture(uint32_t id) = 0;
 		virtual void       UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) = 0;
 		virtual void       ClearBuffer(olc::Pixel p, bool bDepth) = 0;
+		// The last displayed frame, for renderers that draw offscreen, else nullptr
+		virtual const olc::Sprite* GetFrame() { return nullptr; }
 		static olc::PixelGameEngine* ptrPGE;
 	};
 
@@ -643,7 +1030,30 @@ namespace olc
 		virtual olc::rcode SetWindowTitle(const std::string& s) = 0;
 		virtual olc::rcode StartSystemEventLoop() = 0;
 		virtual olc::rcode HandleSystemEvent() = 0;
+		// Blocks until a system event arrives, WakeSystemEvent() is called or fTimeout
+		// seconds pass. By default this suits platforms whose events arrive on another thread
+		virtual olc::rcode WaitSystemEvent(float fTimeout)
+		{
+			std::unique_lock<std::mutex> lock(muxWake);
+			cvWake.wait_for(lock, std::chrono::duration<float>(fTimeout), [&] { return bWake; });
+			bWake = false;
+			return olc::OK;
+		}
+		// Releases WaitSystemEvent(), may be called from any thread
+		virtual olc::rcode WakeSystemEvent()
+		{
+			{
+				std::lock_guard<std::mutex> lock(muxWake);
+				bWake = true;
+			}
+			cvWake.notify_one();
+			return olc::OK;
+		}
 		static olc::PixelGameEngine* ptrPGE;
+	protected:
+		std::mutex muxWake;
+		std::condition_variable cvWake;
+		bool bWake = false;
 	};
 
 	
@@ -652,6 +1062,153 @@ namespace olc
 	static std::unique_ptr<Platform> platform;
 	static std::map<size_t, uint8_t> mapKeys;
 
+#if defined(OLC_PLATFORM_HEADLESS)
+	// O------------------------------------------------------------------------------O
+	// | olc::HeadlessConfig - Drives an application built with OLC_PLATFORM_HEADLESS |
+	// O------------------------------------------------------------------------------O
+	struct HeadlessInput
+	{
+		enum Type { MOUSE_MOVE, MOUSE_DOWN, MOUSE_UP, MOUSE_WHEEL, KEY_DOWN, KEY_UP };
+		// Applied before the update of this frame, the first frame is 0
+		uint32_t nFrame = 0;
+		Type type = MOUSE_MOVE;
+		// Mouse position in screen pixels, x is the delta for MOUSE_WHEEL
+		int32_t x = 0, y = 0;
+		// Mouse button, or olc::Key
+		int32_t nCode = 0;
+	};
+
+	struct HeadlessConfig
+	{
+		// Stops after this many frames, 0 runs until OnUserUpdate() returns false
+		uint32_t nFrames = 0;
+		// Seconds passed to OnUserUpdate() each frame, 0 uses the real time taken
+		float fFrameTime = 0.0f;
+		// Waits between frames like a windowed build, so SetFrameRateLimit() and
+		// SetIdle() apply, otherwise frames run back to back
+		bool bWaitBetweenFrames = false;
+		// Input to replay, in frame order
+		std::vector<olc::HeadlessInput> vecInput;
+		// If set, every nDumpEvery'th frame is saved as <sDumpPrefix><frame>.spr
+		std::string sDumpPrefix;
+		uint32_t nDumpEvery = 1;
+	};
+#endif
+
+	// O------------------------------------------------------------------------------O
+	// | olc::FrameProfiler - Timings of the engine phases and user scopes per frame  |
+	// O------------------------------------------------------------------------------O
+	// The last nCapacity samples of one timing series. Only the engine thread writes,
+	// once per frame, any thread may read without taking a lock
+	class ProfileRing
+	{
+	public:
+		static constexpr uint32_t nCapacity = 256;
+		void Push(float f);
+		// Copies out the samples held, oldest first
+		void Read(std::vector<float>& vOut) const;
+	private:
+		std::array<std::atomic<float>, nCapacity> samples{};
+		std::atomic<uint32_t> nHead{ 0 };
+	};
+
+	class FrameProfiler
+	{
+	public:
+		enum Phase : uint32_t { EVENTS, INPUT, UPDATE, UPLOAD, DRAW, DISPLAY, PHASES };
+		static constexpr uint32_t nMaxScopes = 32;
+
+	public:
+		// Finds or registers a named user scope, its series follows the phases.
+		// Returns nMaxScopes if there are too many
+		uint32_t Scope(const std::string& sName);
+		// Adds time to a user scope for the current frame, safe from any thread
+		void AddTime(uint32_t nScope, float fSeconds);
+		// Pushes one sample to every series, user scopes not timed this frame get 0
+		void EndFrame(const float* pPhaseSeconds);
+		// Number of series, the phases first and then the user scopes
+		uint32_t SeriesCount() const;
+		std::string SeriesName(uint32_t nSeries) const;
+		// Percentile p (0.0f to 1.0f) of the recent samples of a series, in seconds
+		float Percentile(uint32_t nSeries, float p) const;
+		static const char* PhaseName(uint32_t nPhase);
+
+	private:
+		std::array<olc::ProfileRing, PHASES + nMaxScopes> rings;
+		std::array<std::atomic<uint64_t>, nMaxScopes> nScopeNanoseconds{};
+		std::array<std::string, nMaxScopes> sScopeNames;
+		std::atomic<uint32_t> nScopes{ 0 };
+		mutable std::mutex muxScopes;
+	};
+
+	// O------------------------------------------------------------------------------O
+	// | olc::TraceLog - Trace events, saved in the Chrome / Perfetto JSON format     |
+	// O------------------------------------------------------------------------------O
+	// Every thread records into its own buffer, so threads only contend while saving
+	class TraceLog
+	{
+	public:
+		// Events beyond this many on one thread are dropped, and counted
+		static constexpr size_t nMaxEventsPerThread = 1 << 20;
+
+	public:
+		TraceLog();
+		// Records a span on the calling thread. Names are kept by pointer, so must
+		// outlive the log, string literals or Name() will do
+		void Complete(const char* sName, std::chrono::steady_clock::time_point tpStart, std::chrono::steady_clock::time_point tpEnd);
+		// Records a point in time on the calling thread
+		void Instant(const char* sName);
+		// Names the calling thread in the trace
+		void SetThreadName(const std::string& sName);
+		// Returns a copy of the string which lives as long as the log
+		const char* Name(const std::string& sName);
+		// Writes every event so far, the log carries on recording
+		olc::rcode Save(const std::string& sFile);
+
+	private:
+		struct Event
+		{
+			const char* sName;
+			char cPhase;
+			int64_t nStart, nDuration;
+		};
+
+		struct ThreadBuffer
+		{
+			uint32_t nThread = 0;
+			std::string sName;
+			std::vector<Event> vecEvents;
+			size_t nDropped = 0;
+			std::mutex mux;
+		};
+
+		ThreadBuffer& Local();
+		void Record(const Event& e);
+
+		static std::atomic<uint32_t> nNextLog;
+		const uint32_t nLog;
+		const std::chrono::steady_clock::time_point tpOrigin;
+		std::list<ThreadBuffer> listBuffers;
+		std::map<std::string, bool> mapNames;
+		std::mutex muxLog;
+	};
+
+	// Times from its construction to the end of the enclosing block, into a named scope
+	// of the engine's profiler, and as a span of the trace. Does nothing unless the
+	// profiler or tracing is enabled
+	class ProfileScope
+	{
+	public:
+		ProfileScope(olc::PixelGameEngine* pge, const std::string& sName);
+		~ProfileScope();
+	private:
+		olc::FrameProfiler* pProfiler = nullptr;
+		olc::TraceLog* pTrace = nullptr;
+		const char* sTraceName = nullptr;
+		uint32_t nScope = 0;
+		std::chrono::steady_clock::time_point tpStart;
+	};
+
 	// O------------------------------------------------------------------------------O
 	// | olc::PixelGameEngine - The main BASE class for your application              |
 	// O------------------------------------------------------------------------------O
@@ -662,7 +1219,7 @@ namespace olc
 		virtual ~PixelGameEngine();
 	public:
 		olc::rcode Construct(int32_t screen_w, int32_t screen_h, int32_t pixel_w, int32_t pixel_h,
-			bool full_screen = false, bool vsync = false, bool cohesion = false);
+			bool full_screen = false, bool vsync = false, bool cohesion = false, olc::GfxBackend backend = olc::GfxBackend::DEFAULT);
 		olc::rcode Start();
 
 	public: // User Override Interfaces
@@ -717,6 +1274,33 @@ namespace olc
 		const olc::vi2d& GetPixelSize() const;
 		// Gets actual pixel scale
 		const olc::vi2d& GetScreenPixelSize() const;
+		// Limits the frame rate by sleeping between frames, 0 runs as fast as possible
+		void SetFrameRateLimit(float fFPS);
+		// While idle, the engine waits for input, or for WakeUp(), before running
+		// the next frame. Use it when nothing on screen is animating
+		void SetIdle(bool bIdle);
+		// Wakes the engine when idle, safe to call from any thread
+		void WakeUp();
+		// Times each phase of every frame, and any olc::ProfileScope in user code
+		void EnableProfiler(bool b);
+		// Draws the p50 and p99 of each phase and scope as bars over layer 0, the full
+		// width being a 60Hz frame. Enables the profiler too
+		void EnableProfilerOverlay(bool b);
+		// The profiler, or nullptr while it is disabled
+		olc::FrameProfiler* GetProfiler();
+		// Records frames, their phases and any olc::ProfileScope as trace events. They
+		// are written to sFile on exit, and whenever SaveTrace() is called
+		void EnableTracing(bool b, const std::string& sFile = "trace.json");
+		olc::rcode SaveTrace();
+		// The trace log, or nullptr while tracing is disabled
+		olc::TraceLog* GetTrace();
+		// The last composited frame, when using the software renderer or the OpenGL
+		// renderers with OLC_HEADLESS_EGL, else nullptr
+		const olc::Sprite* GetRenderedFrame() const;
+#if defined(OLC_PLATFORM_HEADLESS)
+		// Frame count, fixed time step, scripted input and frame dumps, set before Start()
+		olc::HeadlessConfig& GetHeadlessConfig();
+#endif
 
 	public: // CONFIGURATION ROUTINES
 		// Layer targeting functions
@@ -728,6 +1312,18 @@ namespace olc
 		void SetLayerScale(uint8_t layer, float x, float y);
 		void SetLayerTint(uint8_t layer, const olc::Pixel& tint);
 		void SetLayerCustomRenderFunction(uint8_t layer, std::function<void()> f);
+		// When enabled, layers are only uploaded where something was drawn to them
+		// since the last frame. If you write to a layer sprite directly, set its
+		// bUpdate flag via GetLayers() so it is uploaded in full
+		void EnableDirtyTracking(bool b);
+		// When enabled, Draw(), Clear(), FillRect(), FillTriangle(), DrawSprite() and
+		// DrawString() are recorded, then drawn after OnUserUpdate() by nWorkers
+		// threads (0 for one per core), each owning a band of rows. Recorded calls
+		// keep pointers to their target and sprite, so keep those alive and unchanged
+		// until FlushDrawing(). Custom pixel modes are still drawn immediately
+		void EnableDeferredDrawing(bool b, uint32_t nWorkers = 0);
+		// Draws everything recorded so far, call before reading back pixels
+		void FlushDrawing();
 
 		std::vector<LayerDesc>& GetLayers();
 		uint32_t CreateLayer();
@@ -800,6 +1396,11 @@ namespace olc
 		void DrawPartialRotatedDecal(const olc::vf2d& pos, olc::Decal* decal, const float fAngle, const olc::vf2d& center, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::vf2d& scale = { 1.0f, 1.0f }, const olc::Pixel& tint = olc::WHITE);
 		// Draws a multiline string as a decal, with tiniting and scaling
 		void DrawStringDecal(const olc::vf2d& pos, const std::string& sText, const Pixel col = olc::WHITE, const olc::vf2d& scale = { 1.0f, 1.0f });
+		// Makes DrawStringDecal() take its glyphs from a copy of GetFontSprite() at
+		// vOffset in decal, such as an atlas page. nullptr goes back to the built in font
+		void SetFontDecal(olc::Decal* decal = nullptr, const olc::vi2d& vOffset = { 0, 0 });
+		// The built in font, 16 by 6 glyphs of 8x8 pixels, white on clear
+		const olc::Sprite* GetFontSprite() const;
 		// Draws a single shaded filled rectangle as a decal
 		void FillRectDecal(const olc::vf2d& pos, const olc::vf2d& size, const olc::Pixel col = olc::WHITE);
 		// Draws a corner shaded rectangle as a decal
@@ -846,13 +1447,37 @@ namespace olc
 		int			nFrameCount = 0;
 		Sprite*     fontSprite = nullptr;
 		Decal*      fontDecal = nullptr;
+		Decal*      pUserFontDecal = nullptr;
+		olc::vf2d   vUserFontOffset = { 0.0f, 0.0f };
 		Sprite*     pDefaultDrawTarget = nullptr;
 		std::vector<LayerDesc> vLayers;
 		uint8_t		nTargetLayer = 0;
 		uint32_t	nLastFPS = 0;
 		bool        bPixelCohesion = false;
+		bool        bDirtyTracking = false;
+		bool        bDirtyBatch = false;
+		std::vector<olc::Pixel> vecSpanRow;
+		float       fFrameRateLimit = 0.0f;
+		bool        bIdle = false;
+		std::chrono::time_point<std::chrono::steady_clock> m_tpNextFrame;
 		std::function<olc::Pixel(const int x, const int y, const olc::Pixel&, const olc::Pixel&)> funcPixelMode;
+		std::unique_ptr<olc::FrameProfiler> pProfiler;
+		std::atomic<bool> bProfile{ false };
+		bool        bProfileOverlay = false;
+		std::unique_ptr<olc::TraceLog> pTrace;
+		std::atomic<bool> bTrace{ false };
+		std::string sTraceFile;
+
+		// Runs of lit pixels along each glyph row, built with the font so that text
+		// is drawn without reading the font sprite. The runs of glyph g are
+		// vecGlyphRuns[nGlyphRunStart[g]] up to vecGlyphRuns[nGlyphRunStart[g + 1]]
+		struct GlyphRun { uint8_t x, y, len; };
+		std::vector<GlyphRun> vecGlyphRuns;
+		std::array<uint16_t, 97> nGlyphRunStart = { 0 };
 		std::chrono::time_point<std::chrono::system_clock> m_tp1, m_tp2;
+#if defined(OLC_PLATFORM_HEADLESS)
+		olc::HeadlessConfig cfgHeadless;
+#endif
 
 		// State of keyboard		
 		bool		pKeyNewState[256] = { 0 };
@@ -867,9 +1492,69 @@ namespace olc
 		// The main engine thread
 		void		EngineThread();
 
+		// Grows the dirty region of the targeted layer to include this area
+		void		olc_MarkDirty(int32_t x, int32_t y, int32_t w, int32_t h);
+
+		// Sleeps between frames when idle or frame rate limited
+		void		olc_WaitNextFrame();
+
+		// Draws the profiler overlay with decals on layer 0
+		void		olc_DrawProfilerOverlay();
+
+		// The raster routines behind the drawing functions, they draw into a target
+		// with a given mode, clipped to a rectangle that is either the whole target,
+		// or one worker's band of it when drawing is deferred
+		struct RasterState
+		{
+			Sprite* pTarget = nullptr;
+			Pixel::Mode nMode = Pixel::NORMAL;
+			float fBlend = 1.0f;
+			olc::vi2d vClipMin, vClipMax;
+			std::vector<olc::Pixel>* pRow = nullptr;
+		};
+		RasterState	olc_RasterState();
+		bool		olc_Plot(Sprite* pTarget, Pixel::Mode nMode, float fBlend, int32_t x, int32_t y, Pixel p);
+		void		olc_RasterSpan(const RasterState& rs, int32_t x1, int32_t x2, int32_t y, Pixel p);
+		void		olc_RasterRect(const RasterState& rs, int32_t x, int32_t y, int32_t w, int32_t h, Pixel p);
+		void		olc_RasterTriangle(const RasterState& rs, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p);
+		void		olc_RasterSprite(const RasterState& rs, int32_t x, int32_t y, Sprite* sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, int32_t s, uint8_t flip);
+		void		olc_RasterString(const RasterState& rs, int32_t x, int32_t y, const char* sText, size_t nLength, Pixel col, uint32_t scale);
+
+		// Deferred drawing, one recorded call with the state it was made in
+		struct DrawCommand
+		{
+			enum : uint8_t { PIXEL, CLEAR, RECT, TRIANGLE, SPRITE, STRING };
+			uint8_t nType = PIXEL;
+			uint8_t nFlip = 0;
+			Pixel::Mode nMode = Pixel::NORMAL;
+			Pixel p;
+			float fBlend = 1.0f;
+			Sprite* pTarget = nullptr;
+			Sprite* pSprite = nullptr;
+			int32_t v[7] = { 0 };
+		};
+		bool		bDeferred = false;
+		std::vector<DrawCommand> vecDrawCommands;
+		std::string sDrawText;
+		std::vector<std::thread> vecDrawWorkers;
+		std::vector<std::vector<olc::Pixel>> vecWorkerRows;
+		std::mutex muxDraw;
+		std::condition_variable cvDrawStart, cvDrawDone;
+		uint32_t	nDrawGeneration = 0;
+		uint32_t	nDrawPending = 0;
+		bool		bDrawWorkersQuit = false;
+		// Sprites drawn into and drawn from by the recorded commands
+		std::vector<Sprite*> vecDeferTargets, vecDeferSources;
+		bool		olc_Defer(Sprite* pSource = nullptr);
+		void		olc_FlushIfShared(Sprite* pSource);
+		void		olc_RecordDraw(uint8_t nType, Pixel p, std::initializer_list<int32_t> args, Sprite* pSprite = nullptr, uint8_t nFlip = 0);
+		void		olc_DrawWorker(uint32_t nWorker, uint32_t nGeneration);
+		void		olc_StopDrawWorkers();
+
 		// At the very end of this file, chooses which
 		// components to compile
 		void        olc_ConfigureSystem();
+		olc::rcode  olc_SelectRenderer(olc::GfxBackend backend);
 
 		// If anything sets this flag to false, the engine
 		// "should" shut down gracefully
@@ -940,6 +1625,19 @@ namespace olc
 #ifdef OLC_PGE_APPLICATION
 #undef OLC_PGE_APPLICATION
 
+// For olc::MappedFile
+#if defined(_WIN32)
+	#if !defined(NOMINMAX)
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
 // O------------------------------------------------------------------------------O
 // | olcPixelGameEngine INTERFACE IMPLEMENTATION (CORE)                           |
 // | Note: The core implementation is platform independent                        |
@@ -994,15 +1692,23 @@ namespace olc
 			pColData[i] = Pixel();
 	}
 
+	Sprite::Sprite(int32_t w, int32_t h, Pixel* pData)
+	{
+		width = w;		height = h;
+		pColData = pData;
+		bOwnsData = false;
+	}
+
 	Sprite::~Sprite()
 	{
-		if (pColData) delete[] pColData;
+		if (pColData && bOwnsData) delete[] pColData;
 	}
 
 
 	olc::rcode Sprite::LoadFromPGESprFile(const std::string& sImageFile, olc::ResourcePack* pack)
 	{
-		if (pColData) delete[] pColData;
+		if (pColData && bOwnsData) delete[] pColData;
+		pColData = nullptr; bOwnsData = true;
 		auto ReadData = [&](std::istream& is)
 		{
 			is.read((char*)&width, sizeof(int32_t));
@@ -1202,1596 +1908,4000 @@ namespace olc
 	{ return pSprite.get(); }
 
 	// O------------------------------------------------------------------------------O
-	// | olc::ResourcePack IMPLEMENTATION                                             |
+	// | olc::SpriteAtlas IMPLEMENTATION                                              |
 	// O------------------------------------------------------------------------------O
-
-
-	//=============================================================
-	// Resource Packs - Allows you to store files in one large 
-	// scrambled file - Thanks MaGetzUb for debugging a null char in std::stringstream bug
-	ResourceBuffer::ResourceBuffer(std::ifstream& ifs, uint32_t offset, uint32_t size)
+	namespace
 	{
-		vMemory.resize(size);
-		ifs.seekg(offset); ifs.read(vMemory.data(), vMemory.size());
-		setg(vMemory.data(), vMemory.data(), vMemory.data() + size);
+		struct AtlasHeader { char magic[4]; uint32_t nVersion, nPages, nRegions, nNameBytes; uint32_t reserved[3]; };
+		struct AtlasPage { uint32_t nWidth, nHeight; uint64_t nOffset; };
+		struct AtlasRegion { uint32_t nName, nNameLength, nPage; int32_t x, y, w, h; uint32_t reserved; };
+		static_assert(sizeof(AtlasHeader) == 32 && sizeof(AtlasPage) == 16 && sizeof(AtlasRegion) == 32, "Atlas file layout");
 	}
 
-	ResourcePack::ResourcePack() { }
-	ResourcePack::~ResourcePack() { baseFile.close(); }
+	SpriteAtlas::~SpriteAtlas()
+	{ Clear(); }
 
-	bool ResourcePack::AddFile(const std::string& sFile)
+	void SpriteAtlas::Clear()
 	{
-		const std::string file = makeposix(sFile);
-
-		if (_gfs::exists(file))
-		{
-			sResourceFile e;
-			e.nSize = (uint32_t)_gfs::file_size(file);
-			e.nOffset = 0; // Unknown at this stage			
-			mapFiles[file] = e;
-			return true;
-		}
-		return false;
+		// Pages may refer to the mapping, so go first
+		vecPages.clear();
+		mapRegions.clear();
+		file.Close();
 	}
 
-	bool ResourcePack::LoadPack(const std::string& sFile, const std::string& sKey)
+	olc::rcode SpriteAtlas::LoadFromFile(const std::string& sFile)
 	{
-		// Open the resource file
-		baseFile.open(sFile, std::ifstream::binary);
-		if (!baseFile.is_open()) return false;
-
-		// 1) Read Scrambled index
-		uint32_t nIndexSize = 0;
-		baseFile.read((char*)&nIndexSize, sizeof(uint32_t));
-
-		std::vector<char> buffer(nIndexSize);
-		for (uint32_t j = 0; j < nIndexSize; j++)
-			buffer[j] = baseFile.get();
-
-		std::vector<char> decoded = scramble(buffer, sKey);
-		size_t pos = 0;
-		auto read = [&decoded, &pos](char* dst, size_t size) {
-			memcpy((void*)dst, (const void*)(decoded.data() + pos), size);
-			pos += size;
-		};
-
-		auto get = [&read]() -> int {
-			char c;
-			read(&c, 1);
-			return c;
-		};
-
-		// 2) Read Map
-		uint32_t nMapEntries = 0;
-		read((char*)&nMapEntries, sizeof(uint32_t));
-		for (uint32_t i = 0; i < nMapEntries; i++)
+		Clear();
+		if (!file.Open(sFile)) return olc::NO_FILE;
+
+		// Everything is checked against the size of the file before use, as it
+		// is read in place
+		const uint8_t* pData = file.Data();
+		const size_t nSize = file.Size();
+		AtlasHeader header;
+		if (nSize < sizeof(AtlasHeader)) { Clear(); return olc::FAIL; }
+		std::memcpy(&header, pData, sizeof(AtlasHeader));
+		if (std::memcmp(header.magic, "PGEA", 4) != 0 || header.nVersion != nVersion) { Clear(); return olc::FAIL; }
+
+		const uint64_t nPageTable = sizeof(AtlasHeader);
+		const uint64_t nRegionTable = nPageTable + uint64_t(header.nPages) * sizeof(AtlasPage);
+		const uint64_t nNames = nRegionTable + uint64_t(header.nRegions) * sizeof(AtlasRegion);
+		if (nNames + header.nNameBytes > nSize) { Clear(); return olc::FAIL; }
+
+		for (uint32_t i = 0; i < header.nPages; i++)
 		{
-			uint32_t nFilePathSize = 0;
-			read((char*)&nFilePathSize, sizeof(uint32_t));
-
-			std::string sFileName(nFilePathSize, ' ');
-			for (uint32_t j = 0; j < nFilePathSize; j++)
-				sFileName[j] = get();
+			AtlasPage page;
+			std::memcpy(&page, pData + nPageTable + i * sizeof(AtlasPage), sizeof(AtlasPage));
+			const uint64_t nBytes = uint64_t(page.nWidth) * page.nHeight * sizeof(olc::Pixel);
+			if (page.nWidth > INT32_MAX || page.nHeight > INT32_MAX || page.nOffset % alignof(olc::Pixel) != 0
+				|| page.nOffset > nSize || nBytes > nSize - page.nOffset) { Clear(); return olc::FAIL; }
+			vecPages.push_back(std::make_unique<olc::Sprite>(int32_t(page.nWidth), int32_t(page.nHeight), (olc::Pixel*)(file.Data() + page.nOffset)));
+		}
 
-			sResourceFile e;
-			read((char*)&e.nSize, sizeof(uint32_t));
-			read((char*)&e.nOffset, sizeof(uint32_t));
-			mapFiles[sFileName] = e;
+		for (uint32_t i = 0; i < header.nRegions; i++)
+		{
+			AtlasRegion region;
+			std::memcpy(&region, pData + nRegionTable + i * sizeof(AtlasRegion), sizeof(AtlasRegion));
+			if (uint64_t(region.nName) + region.nNameLength > header.nNameBytes) { Clear(); return olc::FAIL; }
+			const std::string sName((const char*)pData + nNames + region.nName, region.nNameLength);
+			if (!AddRegion(sName, region.nPage, { region.x, region.y }, { region.w, region.h })) { Clear(); return olc::FAIL; }
 		}
 
-		// Don't close base file! we will provide a stream
-		// pointer when the file is requested
-		return true;
+		return olc::OK;
 	}
 
-	bool ResourcePack::SavePack(const std::string& sFile, const std::string& sKey)
+	olc::rcode SpriteAtlas::SaveToFile(const std::string& sFile) const
 	{
-		// Create/Overwrite the resource file
-		std::ofstream ofs(sFile, std::ofstream::binary);
-		if (!ofs.is_open()) return false;
-
-		// Iterate through map
-		uint32_t nIndexSize = 0; // Unknown for now
-		ofs.write((char*)&nIndexSize, sizeof(uint32_t));
-		uint32_t nMapSize = uint32_t(mapFiles.size());
-		ofs.write((char*)&nMapSize, sizeof(uint32_t));
-		for (auto& e : mapFiles)
+		std::string sNames;
+		std::vector<AtlasRegion> vRegions;
+		for (const auto& r : mapRegions)
 		{
-			// Write the path of the file
-			size_t nPathSize = e.first.size();
-			ofs.write((char*)&nPathSize, sizeof(uint32_t));
-			ofs.write(e.first.c_str(), nPathSize);
-
-			// Write the file entry properties
-			ofs.write((char*)&e.second.nSize, sizeof(uint32_t));
-			ofs.write((char*)&e.second.nOffset, sizeof(uint32_t));
+			vRegions.push_back({ uint32_t(sNames.size()), uint32_t(r.first.size()), r.second.nPage,
+				r.second.pos.x, r.second.pos.y, r.second.size.x, r.second.size.y, 0 });
+			sNames += r.first;
 		}
 
-		// 2) Write the individual Data
-		std::streampos offset = ofs.tellp();
-		nIndexSize = (uint32_t)offset;
-		for (auto& e : mapFiles)
-		{
-			// Store beginning of file offset within resource pack file
-			e.second.nOffset = (uint32_t)offset;
-
-			// Load the file to be added
-			std::vector<uint8_t> vBuffer(e.second.nSize);
-			std::ifstream i(e.first, std::ifstream::binary);
-			i.read((char*)vBuffer.data(), e.second.nSize);
-			i.close();
+		AtlasHeader header = { { 'P', 'G', 'E', 'A' }, nVersion, uint32_t(vecPages.size()), uint32_t(vRegions.size()), uint32_t(sNames.size()), { 0, 0, 0 } };
 
-			// Write the loaded file into resource pack file
-			ofs.write((char*)vBuffer.data(), e.second.nSize);
-			offset += e.second.nSize;
+		// Pixels follow the names, each page aligned
+		auto Align = [](uint64_t n) { return (n + nAlignment - 1) / nAlignment * nAlignment; };
+		std::vector<AtlasPage> vPages;
+		uint64_t nOffset = sizeof(AtlasHeader) + vecPages.size() * sizeof(AtlasPage) + vRegions.size() * sizeof(AtlasRegion) + sNames.size();
+		for (const auto& page : vecPages)
+		{
+			nOffset = Align(nOffset);
+			vPages.push_back({ uint32_t(page->width), uint32_t(page->height), nOffset });
+			nOffset += uint64_t(page->width) * page->height * sizeof(olc::Pixel);
 		}
 
-		// 3) Scramble Index
-		std::vector<char> stream;
-		auto write = [&stream](const char* data, size_t size) {
-			size_t sizeNow = stream.size();
-			stream.resize(sizeNow + size);
-			memcpy(stream.data() + sizeNow, data, size);
-		};
-
-		// Iterate through map
-		write((char*)&nMapSize, sizeof(uint32_t));
-		for (auto& e : mapFiles)
+		// Written beside the file then renamed over it, as the pages may be mapped
+		// from the very file being saved
+		const std::string sTemp = sFile + ".tmp";
+		std::ofstream ofs(sTemp, std::ofstream::binary);
+		if (!ofs.is_open()) return olc::FAIL;
+		ofs.write((const char*)&header, sizeof(AtlasHeader));
+		ofs.write((const char*)vPages.data(), vPages.size() * sizeof(AtlasPage));
+		ofs.write((const char*)vRegions.data(), vRegions.size() * sizeof(AtlasRegion));
+		ofs.write(sNames.data(), sNames.size());
+		for (size_t i = 0; i < vecPages.size(); i++)
 		{
-			// Write the path of the file
-			size_t nPathSize = e.first.size();
-			write((char*)&nPathSize, sizeof(uint32_t));
-			write(e.first.c_str(), nPathSize);
-
-			// Write the file entry properties
-			write((char*)&e.second.nSize, sizeof(uint32_t));
-			write((char*)&e.second.nOffset, sizeof(uint32_t));
+			const char zeros[nAlignment] = {};
+			ofs.write(zeros, std::streamsize(vPages[i].nOffset - uint64_t(ofs.tellp())));
+			ofs.write((const char*)vecPages[i]->GetData(), std::streamsize(uint64_t(vPages[i].nWidth) * vPages[i].nHeight * sizeof(olc::Pixel)));
 		}
-		std::vector<char> sIndexString = scramble(stream, sKey);
-		uint32_t nIndexStringLen = uint32_t(sIndexString.size());
-		// 4) Rewrite Map (it has been updated with offsets now)
-		// at start of file
-		ofs.seekp(0, std::ios::beg);
-		ofs.write((char*)&nIndexStringLen, sizeof(uint32_t));
-		ofs.write(sIndexString.data(), nIndexStringLen);
+		const bool bWritten = ofs.good();
 		ofs.close();
-		return true;
+
+		std::error_code ec;
+		if (bWritten) _gfs::rename(sTemp, sFile, ec);
+		if (!bWritten || ec)
+		{
+			_gfs::remove(sTemp, ec);
+			return olc::FAIL;
+		}
+		return olc::OK;
 	}
 
-	ResourceBuffer ResourcePack::GetFileBuffer(const std::string& sFile)
+	uint32_t SpriteAtlas::AddPage(std::unique_ptr<olc::Sprite> spr)
 	{
-		return ResourceBuffer(baseFile, mapFiles[sFile].nOffset, mapFiles[sFile].nSize);
+		vecPages.push_back(std::move(spr));
+		return uint32_t(vecPages.size() - 1);
 	}
 
-	bool ResourcePack::Loaded()
-	{ return baseFile.is_open(); }
-
-	std::vector<char> ResourcePack::scramble(const std::vector<char>& data, const std::string& key)
+	bool SpriteAtlas::AddRegion(const std::string& sName, uint32_t nPage, const olc::vi2d& pos, const olc::vi2d& size)
 	{
-		if (key.empty()) return data;
-		std::vector<char> o;
-		size_t c = 0;
-		for (auto s : data)	o.push_back(s ^ key[(c++) % key.size()]);
-		return o;
-	};
+		// Regions must lie within their page
+		const olc::Sprite* page = GetPage(nPage);
+		if (page == nullptr || pos.x < 0 || pos.y < 0 || size.x < 0 || size.y < 0
+			|| int64_t(pos.x) + size.x > page->width || int64_t(pos.y) + size.y > page->height) return false;
+		mapRegions[sName] = { nPage, pos, size };
+		return true;
+	}
 
-	std::string ResourcePack::makeposix(const std::string& path)
+	olc::Sprite* SpriteAtlas::GetPage(uint32_t nPage) const
+	{ return nPage < vecPages.size() ? vecPages[nPage].get() : nullptr; }
+
+	const SpriteAtlas::Region* SpriteAtlas::GetRegion(const std::string& sName) const
 	{
-		std::string o;
-		for (auto s : path) o += std::string(1, s == '\\' ? '/' : s);
-		return o;
-	};
+		auto it = mapRegions.find(sName);
+		return it == mapRegions.end() ? nullptr : &it->second;
+	}
+
+	uint32_t SpriteAtlas::PageCount() const
+	{ return uint32_t(vecPages.size()); }
+
+	const std::map<std::string, SpriteAtlas::Region>& SpriteAtlas::Regions() const
+	{ return mapRegions; }
 
 	// O------------------------------------------------------------------------------O
-	// | olc::PixelGameEngine IMPLEMENTATION                                          |
+	// | olc::AtlasBuilder IMPLEMENTATION                                             |
 	// O------------------------------------------------------------------------------O
-	PixelGameEngine::PixelGameEngine()
+	AtlasBuilder::AtlasBuilder(int32_t padding, int32_t maxSize)
 	{
-		sAppName = "Undefined";
-		olc::PGEX::pge = this;
+		nPadding = padding; nMaxSize = maxSize;
+	}
 
-		// Bring in relevant Platform & Rendering systems depending
-		// on compiler parameters
-		olc_ConfigureSystem();
-	}
-
-	PixelGameEngine::~PixelGameEngine()
-	{}
-
-
-	olc::rcode PixelGameEngine::Construct(int32_t screen_w, int32_t screen_h, int32_t pixel_w, int32_t pixel_h, bool full_screen, bool vsync, bool cohesion)
+	bool AtlasBuilder::Add(const std::string& sName, const olc::Sprite* spr)
 	{
-		bPixelCohesion = cohesion;
-		vScreenSize = { screen_w, screen_h };
-		vInvScreenSize = { 1.0f / float(screen_w), 1.0f / float(screen_h) };
-		vPixelSize = { pixel_w, pixel_h };
-		vWindowSize = vScreenSize * vPixelSize;
-		bFullScreen = full_screen;
-		bEnableVSYNC = vsync;
-		vPixel = 2.0f / vScreenSize;
-
-		if (vPixelSize.x <= 0 || vPixelSize.y <= 0 || vScreenSize.x <= 0 || vScreenSize.y <= 0)
-			return olc::FAIL;
-
-
-		return olc::OK;
+		if (spr == nullptr) return false;
+		return Add(sName, spr, { 0, 0 }, { spr->width, spr->height });
 	}
 
-
-	void PixelGameEngine::SetScreenSize(int w, int h)
+	bool AtlasBuilder::Add(const std::string& sName, const olc::Sprite* spr, const olc::vi2d& vPos, const olc::vi2d& vSize)
 	{
-		vScreenSize = { w, h };
-		vInvScreenSize = { 1.0f / float(w), 1.0f / float(h) };
-		for (auto& layer : vLayers)
-		{
-			delete layer.pDrawTarget; // Erase existing layer sprites
-			layer.pDrawTarget = new Sprite(vScreenSize.x, vScreenSize.y);
-			layer.bUpdate = true;
-		}
-		SetDrawTarget(nullptr);
-
-		renderer->ClearBuffer(olc::BLACK, true);
-		renderer->DisplayFrame();
-		renderer->ClearBuffer(olc::BLACK, true);
-		renderer->UpdateViewport(vViewPos, vViewSize);
+		if (spr == nullptr || spr->pColData == nullptr || vSize.x <= 0 || vSize.y <= 0) return false;
+		vecEntries.push_back({ sName, spr, vPos, vSize, { 0, 0 } });
+		return true;
 	}
 
-#if !defined(PGE_USE_CUSTOM_START)
-	olc::rcode PixelGameEngine::Start()
+	bool AtlasBuilder::Pack(int32_t nWidth, int32_t nHeight)
 	{
-		if (platform->ApplicationStartUp() != olc::OK) return olc::FAIL;
-
-		// Construct the window
-		if (platform->CreateWindowPane({ 30,30 }, vWindowSize, bFullScreen) != olc::OK) return olc::FAIL;
-		olc_UpdateWindowSize(vWindowSize.x, vWindowSize.y);
-
-		// Start the thread
-		bAtomActive = true;
-		std::thread t = std::thread(&PixelGameEngine::EngineThread, this);
-
-		// Some implementations may form an event loop here
-		platform->StartSystemEventLoop();
+		// Skyline packing, the top edge of what has been placed so far is kept as
+		// spans of the page width. Each sprite goes where its bottom edge would be
+		// highest, leftmost on a tie, then the spans it covers are raised
+		struct Span { int32_t x, y, w; };
+		std::vector<Span> vSkyline = { { 0, 0, nWidth } };
 
-		// Wait for thread to be exited
-		t.join();
+		for (auto& e : vecEntries)
+		{
+			const int32_t w = e.vSize.x + nPadding, h = e.vSize.y + nPadding;
+			size_t nBest = SIZE_MAX;
+			int32_t nBestTop = INT32_MAX, nBestY = 0;
+			for (size_t i = 0; i < vSkyline.size(); i++)
+			{
+				if (vSkyline[i].x + w > nWidth) break;
+				int32_t y = 0;
+				for (size_t j = i, nCovered = 0; nCovered < size_t(w); j++)
+				{
+					y = std::max(y, vSkyline[j].y);
+					nCovered = size_t(vSkyline[j].x + vSkyline[j].w - vSkyline[i].x);
+				}
+				if (y + h <= nHeight && y + h < nBestTop)
+				{
+					nBest = i; nBestTop = y + h; nBestY = y;
+				}
+			}
+			if (nBest == SIZE_MAX) return false;
 
-		if (platform->ApplicationCleanUp() != olc::OK) return olc::FAIL;
+			const int32_t x = vSkyline[nBest].x;
+			e.vPlaced = { x, nBestY };
 
-		return olc::OK;
+			// Trim away the spans now under the sprite, then merge equal neighbours
+			size_t j = nBest;
+			while (j < vSkyline.size() && vSkyline[j].x < x + w)
+			{
+				const int32_t nEnd = vSkyline[j].x + vSkyline[j].w;
+				if (nEnd <= x + w) vSkyline.erase(vSkyline.begin() + j);
+				else { vSkyline[j].w = nEnd - (x + w); vSkyline[j].x = x + w; break; }
+			}
+			vSkyline.insert(vSkyline.begin() + nBest, { x, nBestTop, w });
+			for (size_t k = 0; k + 1 < vSkyline.size();)
+			{
+				if (vSkyline[k].y == vSkyline[k + 1].y) { vSkyline[k].w += vSkyline[k + 1].w; vSkyline.erase(vSkyline.begin() + k + 1); }
+				else k++;
+			}
+		}
+		return true;
 	}
-#endif
 
-	void PixelGameEngine::SetDrawTarget(Sprite* target)
+	olc::rcode AtlasBuilder::Build(olc::SpriteAtlas& atlas)
 	{
-		if (target)
+		// Tallest first packs tightest. The order is made stable so that the same
+		// sprites always give the same page
+		std::stable_sort(vecEntries.begin(), vecEntries.end(), [](const Entry& a, const Entry& b)
+			{ return a.vSize.y != b.vSize.y ? a.vSize.y > b.vSize.y : a.vSize.x > b.vSize.x; });
+
+		// Pages are tried smallest first, starting from the total area, and for each
+		// area the squarest shape wide side first, then tall side first
+		int64_t nArea = 0;
+		int32_t nWidest = 1, nTallest = 1;
+		for (const auto& e : vecEntries)
 		{
-			pDrawTarget = target;
-		}
-		else
-		{
-			nTargetLayer = 0;
-			pDrawTarget = vLayers[0].pDrawTarget;
+			nArea += int64_t(e.vSize.x + nPadding) * (e.vSize.y + nPadding);
+			nWidest = std::max(nWidest, e.vSize.x + nPadding);
+			nTallest = std::max(nTallest, e.vSize.y + nPadding);
 		}
-	}
+		int64_t nPageArea = 1;
+		while (nPageArea < nArea) nPageArea *= 2;
 
-	void PixelGameEngine::SetDrawTarget(uint8_t layer)
-	{
-		if (layer < vLayers.size())
+		int32_t nWidth = 0, nHeight = 0;
+		for (; nWidth == 0 && nPageArea <= int64_t(nMaxSize) * nMaxSize; nPageArea *= 2)
 		{
-			pDrawTarget = vLayers[layer].pDrawTarget;
-			vLayers[layer].bUpdate = true;
-			nTargetLayer = layer;
+			int32_t nSide = 1;
+			while (int64_t(nSide) * nSide < nPageArea) nSide *= 2;
+			const int32_t nOther = int32_t(nPageArea / nSide);
+			for (const auto& [w, h] : { std::make_pair(nSide, nOther), std::make_pair(nOther, nSide) })
+			{
+				if (w > nMaxSize || h > nMaxSize || w < nWidest || h < nTallest) continue;
+				if (Pack(w, h)) { nWidth = w; nHeight = h; break; }
+			}
 		}
+		if (nWidth == 0) return olc::FAIL;
+
+		auto page = std::make_unique<olc::Sprite>(nWidth, nHeight);
+		for (int32_t i = 0; i < nWidth * nHeight; i++) page->GetData()[i] = olc::BLANK;
+		for (const auto& e : vecEntries)
+			for (int32_t y = 0; y < e.vSize.y; y++)
+				for (int32_t x = 0; x < e.vSize.x; x++)
+					page->SetPixel(e.vPlaced.x + x, e.vPlaced.y + y, e.spr->GetPixel(e.vSource.x + x, e.vSource.y + y));
+
+		const uint32_t nPage = atlas.AddPage(std::move(page));
+		for (const auto& e : vecEntries)
+			atlas.AddRegion(e.sName, nPage, e.vPlaced, e.vSize);
+		vecEntries.clear();
+		return olc::OK;
 	}
 
-	void PixelGameEngine::EnableLayer(uint8_t layer, bool b)
+	// O------------------------------------------------------------------------------O
+	// | olc::AssetManager IMPLEMENTATION                                             |
+	// O------------------------------------------------------------------------------O
+	AssetManager::AssetManager(uint32_t nWorkers, std::function<void()> OnReady)
 	{
-		if (layer < vLayers.size()) vLayers[layer].bShow = b;
+		funcOnReady = std::move(OnReady);
+		if (nWorkers == 0) nWorkers = std::max(1u, std::thread::hardware_concurrency());
+		for (uint32_t i = 0; i < nWorkers; i++) vecWorkers.emplace_back(&AssetManager::Worker, this);
 	}
 
-	void PixelGameEngine::SetLayerOffset(uint8_t layer, const olc::vf2d& offset)
+	AssetManager::~AssetManager()
+	{ Stop(); }
+
+	AssetManager::Handle AssetManager::LoadSprite(const std::string& sImageFile, olc::ResourcePack* pack)
 	{
-		SetLayerOffset(layer, offset.x, offset.y);
+		auto asset = std::make_unique<sAsset>();
+		asset->sFile = sImageFile;
+		asset->pack = pack;
+		{
+			std::lock_guard<std::mutex> lock(muxQueue);
+			if (bQuit)
+				asset->state = State::FAILED;
+			else
+			{
+				listQueued.push_back(asset.get());
+				nLoading++;
+			}
+		}
+		vecAssets.push_back(std::move(asset));
+		cvQueued.notify_one();
+		return Handle(vecAssets.size() - 1);
 	}
 
-	void PixelGameEngine::SetLayerOffset(uint8_t layer, float x, float y)
+	AssetManager::State AssetManager::GetState(Handle h) const
 	{
-		if (layer < vLayers.size()) vLayers[layer].vOffset = { x, y };
+		if (h >= vecAssets.size()) return State::FAILED;
+		return vecAssets[h]->state.load(std::memory_order_acquire);
 	}
 
-	void PixelGameEngine::SetLayerScale(uint8_t layer, const olc::vf2d& scale)
+	olc::Sprite* AssetManager::GetSprite(Handle h) const
 	{
-		SetLayerScale(layer, scale.x, scale.y);
+		if (GetState(h) != State::READY) return nullptr;
+		return vecAssets[h]->sprite.get();
 	}
 
-	void PixelGameEngine::SetLayerScale(uint8_t layer, float x, float y)
+	bool AssetManager::Changed()
+	{ return bChanged.exchange(false); }
+
+	void AssetManager::WaitAll()
 	{
-		if (layer < vLayers.size()) vLayers[layer].vScale = { x, y };
+		std::unique_lock<std::mutex> lock(muxQueue);
+		cvIdle.wait(lock, [&] { return nLoading == 0; });
 	}
 
-	void PixelGameEngine::SetLayerTint(uint8_t layer, const olc::Pixel& tint)
+	void AssetManager::Stop()
 	{
-		if (layer < vLayers.size()) vLayers[layer].tint = tint;
+		{
+			std::lock_guard<std::mutex> lock(muxQueue);
+			bQuit = true;
+		}
+		cvQueued.notify_all();
+		for (auto& t : vecWorkers) t.join();
+		vecWorkers.clear();
+
+		// Nothing is left to decode what is still queued, so WaitAll() must not wait on it
+		{
+			std::lock_guard<std::mutex> lock(muxQueue);
+			for (auto asset : listQueued) asset->state = State::FAILED;
+			nLoading -= uint32_t(listQueued.size());
+			if (!listQueued.empty()) bChanged = true;
+			listQueued.clear();
+		}
+		cvIdle.notify_all();
 	}
 
-	void PixelGameEngine::SetLayerCustomRenderFunction(uint8_t layer, std::function<void()> f)
+	void AssetManager::Worker()
 	{
-		if (layer < vLayers.size()) vLayers[layer].funcHook = f;
-	}
+		while (true)
+		{
+			sAsset* asset = nullptr;
+			{
+				std::unique_lock<std::mutex> lock(muxQueue);
+				cvQueued.wait(lock, [&] { return bQuit || !listQueued.empty(); });
+				if (bQuit) return;
+				asset = listQueued.front();
+				listQueued.pop_front();
+			}
 
-	std::vector<LayerDesc>& PixelGameEngine::GetLayers()
-	{ return vLayers; }
+			// The sprite is only handed over once it is whole
+			auto sprite = std::make_unique<olc::Sprite>();
+			const bool bLoaded = sprite->LoadFromFile(asset->sFile, asset->pack) == olc::rcode::OK;
+			if (bLoaded) asset->sprite = std::move(sprite);
+			asset->state.store(bLoaded ? State::READY : State::FAILED, std::memory_order_release);
+			bChanged = true;
 
-	uint32_t PixelGameEngine::CreateLayer()
-	{
-		LayerDesc ld;
-		ld.pDrawTarget = new olc::Sprite(vScreenSize.x, vScreenSize.y);
-		ld.nResID = renderer->CreateTexture(vScreenSize.x, vScreenSize.y);
-		renderer->UpdateTexture(ld.nResID, ld.pDrawTarget);
-		vLayers.push_back(ld);
-		return uint32_t(vLayers.size()) - 1;
+			{
+				std::lock_guard<std::mutex> lock(muxQueue);
+				nLoading--;
+			}
+			cvIdle.notify_all();
+			if (funcOnReady) funcOnReady();
+		}
 	}
 
-	Sprite* PixelGameEngine::GetDrawTarget() const
-	{ return pDrawTarget; }
+	// O------------------------------------------------------------------------------O
+	// | olc::MappedFile IMPLEMENTATION                                               |
+	// O------------------------------------------------------------------------------O
+	MappedFile::~MappedFile()
+	{ Close(); }
 
-	int32_t PixelGameEngine::GetDrawTargetWidth() const
+	bool MappedFile::Open(const std::string& sFile)
 	{
-		if (pDrawTarget)
-			return pDrawTarget->width;
-		else
-			return 0;
+		Close();
+#if defined(_WIN32)
+		HANDLE f = CreateFileA(sFile.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (f == INVALID_HANDLE_VALUE) return false;
+		hFile = f;
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(f, &size) || size.QuadPart == 0) { Close(); return false; }
+		hMapping = CreateFileMappingA(f, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		if (hMapping == nullptr) { Close(); return false; }
+		pData = (uint8_t*)MapViewOfFile((HANDLE)hMapping, FILE_MAP_COPY, 0, 0, 0);
+		if (pData == nullptr) { Close(); return false; }
+		nSize = size_t(size.QuadPart);
+#else
+		const int fd = open(sFile.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return false; }
+		// The mapping keeps the file alive once the descriptor is closed
+		void* p = mmap(nullptr, size_t(st.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (p == MAP_FAILED) return false;
+		pData = (uint8_t*)p;
+		nSize = size_t(st.st_size);
+#endif
+		return true;
 	}
 
-	int32_t PixelGameEngine::GetDrawTargetHeight() const
+	void MappedFile::Close()
 	{
-		if (pDrawTarget)
-			return pDrawTarget->height;
-		else
-			return 0;
+#if defined(_WIN32)
+		if (pData != nullptr) UnmapViewOfFile(pData);
+		if (hMapping != nullptr) CloseHandle((HANDLE)hMapping);
+		if (hFile != nullptr) CloseHandle((HANDLE)hFile);
+		hMapping = nullptr; hFile = nullptr;
+#else
+		if (pData != nullptr) munmap(pData, nSize);
+#endif
+		pData = nullptr; nSize = 0;
 	}
 
-	uint32_t PixelGameEngine::GetFPS() const
-	{ return nLastFPS; }
+	bool MappedFile::IsOpen() const
+	{ return pData != nullptr; }
 
-	bool PixelGameEngine::IsFocused() const
-	{ return bHasInputFocus; }
+	uint8_t* MappedFile::Data() const
+	{ return pData; }
 
-	HWButton PixelGameEngine::GetKey(Key k) const
-	{ return pKeyboardState[k]; }
+	size_t MappedFile::Size() const
+	{ return nSize; }
 
-	HWButton PixelGameEngine::GetMouse(uint32_t b) const
-	{ return pMouseState[b]; }
+	// O------------------------------------------------------------------------------O
+	// | olc::lz4 IMPLEMENTATION                                                      |
+	// O------------------------------------------------------------------------------O
+	namespace lz4
+	{
+		// A block is a run of sequences, each a token of two 4 bit lengths, the
+		// literals, then a 16 bit offset back to a match of at least 4 bytes. Lengths
+		// of 15 continue in following bytes. The last sequence is literals only
+		constexpr size_t nMinMatch = 4;
+		constexpr size_t nLastLiterals = 5;
+		constexpr size_t nMatchLimit = 12;
+		constexpr size_t nMaxOffset = 65535;
+		constexpr uint32_t nHashBits = 16;
+
+		void Compress(const uint8_t* pSrc, size_t n, std::vector<uint8_t>& vDst)
+		{
+			vDst.clear();
+			vDst.reserve(n + n / 255 + 16);
+			auto Read32 = [pSrc](size_t p) { uint32_t v; std::memcpy(&v, pSrc + p, 4); return v; };
+			auto Hash = [&](size_t p) { return (Read32(p) * 2654435761u) >> (32 - nHashBits); };
+			auto PutLength = [&](size_t nLength) { for (; nLength >= 255; nLength -= 255) vDst.push_back(255); vDst.push_back(uint8_t(nLength)); };
+			auto PutSequence = [&](size_t nLiteral, size_t nLiterals, size_t nMatch, size_t nOffset)
+			{
+				const size_t nMatchCode = nMatch == 0 ? 0 : nMatch - nMinMatch;
+				vDst.push_back(uint8_t((std::min<size_t>(nLiterals, 15) << 4) | std::min<size_t>(nMatchCode, 15)));
+				if (nLiterals >= 15) PutLength(nLiterals - 15);
+				vDst.insert(vDst.end(), pSrc + nLiteral, pSrc + nLiteral + nLiterals);
+				if (nMatch == 0) return;
+				vDst.push_back(uint8_t(nOffset)); vDst.push_back(uint8_t(nOffset >> 8));
+				if (nMatchCode >= 15) PutLength(nMatchCode - 15);
+			};
 
-	int32_t PixelGameEngine::GetMouseX() const
-	{ return vMousePos.x; }
+			// Greedy, with the most recent position of each hashed 4 bytes. The search
+			// steps further the longer it goes without a match, so incompressible data
+			// is passed over quickly
+			size_t nAnchor = 0;
+			if (n >= nMatchLimit)
+			{
+				std::vector<uint32_t> vTable(size_t(1) << nHashBits, UINT32_MAX);
+				size_t i = 0;
+				while (i + nMatchLimit <= n)
+				{
+					const uint32_t h = Hash(i);
+					const size_t nCandidate = vTable[h];
+					vTable[h] = uint32_t(i);
+					if (nCandidate == UINT32_MAX || i - nCandidate > nMaxOffset || Read32(nCandidate) != Read32(i))
+					{
+						i += 1 + ((i - nAnchor) >> 6);
+						continue;
+					}
 
-	int32_t PixelGameEngine::GetMouseY() const
-	{ return vMousePos.y; }
+					size_t nStart = i, nFrom = nCandidate, nLength = nMinMatch;
+					const size_t nMaxLength = n - nLastLiterals - i;
+					while (nLength < nMaxLength && pSrc[nFrom + nLength] == pSrc[nStart + nLength]) nLength++;
+					while (nStart > nAnchor && nFrom > 0 && pSrc[nStart - 1] == pSrc[nFrom - 1]) { nStart--; nFrom--; nLength++; }
 
-	const olc::vi2d& PixelGameEngine::GetMousePos() const
-	{ return vMousePos; }
+					PutSequence(nAnchor, nStart - nAnchor, nLength, nStart - nFrom);
+					i = nAnchor = nStart + nLength;
+				}
+			}
+			PutSequence(nAnchor, n - nAnchor, 0, 0);
+		}
 
-	int32_t PixelGameEngine::GetMouseWheel() const
-	{ return nMouseWheelDelta; }
+		// Copies n bytes 16 at a time, so may write up to 15 more. Those are always
+		// overwritten later, and are only allowed while that far from the end
+		constexpr size_t nWildSlack = 16;
+		inline void WildCopy(uint8_t* pDst, const uint8_t* pSrc, size_t n)
+		{
+			for (uint8_t* pEnd = pDst + n; pDst < pEnd; pDst += 16, pSrc += 16)
+				std::memcpy(pDst, pSrc, 16);
+		}
 
-	int32_t PixelGameEngine::ScreenWidth() const
-	{ return vScreenSize.x; }
+		bool Decompress(const uint8_t* pSrc, size_t nSrc, uint8_t* pDst, size_t nDst)
+		{
+			size_t s = 0, d = 0;
+			auto GetLength = [&](size_t& nLength)
+			{
+				uint8_t b = 255;
+				while (b == 255)
+				{
+					if (s >= nSrc) return false;
+					b = pSrc[s++]; nLength += b;
+				}
+				return true;
+			};
 
-	int32_t PixelGameEngine::ScreenHeight() const
-	{ return vScreenSize.y; }
+			while (s < nSrc)
+			{
+				const uint8_t nToken = pSrc[s++];
+				size_t nLiterals = nToken >> 4;
+				if (nLiterals == 15 && !GetLength(nLiterals)) return false;
+				if (nLiterals > nSrc - s || nLiterals > nDst - d) return false;
+				if (nLiterals + nWildSlack <= nSrc - s && nLiterals + nWildSlack <= nDst - d)
+					WildCopy(pDst + d, pSrc + s, nLiterals);
+				else
+					std::memcpy(pDst + d, pSrc + s, nLiterals);
+				s += nLiterals; d += nLiterals;
+				if (s == nSrc) break;
+
+				if (nSrc - s < 2) return false;
+				const size_t nOffset = size_t(pSrc[s]) | (size_t(pSrc[s + 1]) << 8);
+				s += 2;
+				size_t nLength = nToken & 15;
+				if (nLength == 15 && !GetLength(nLength)) return false;
+				nLength += nMinMatch;
+				if (nOffset == 0 || nOffset > d || nLength > nDst - d) return false;
+
+				if (nOffset >= nWildSlack && nLength + nWildSlack <= nDst - d)
+				{
+					WildCopy(pDst + d, pDst + d - nOffset, nLength);
+					d += nLength;
+					continue;
+				}
 
-	float PixelGameEngine::GetElapsedTime() const
-	{ return fLastElapsed; }
+				// Matches may overlap what they write. What has been copied repeats
+				// every nOffset bytes, so the distance copied from can double each time
+				for (size_t nFrom = nOffset; nLength > 0; nFrom *= 2)
+				{
+					const size_t nChunk = std::min(nLength, nFrom);
+					std::memcpy(pDst + d, pDst + d - nFrom, nChunk);
+					d += nChunk; nLength -= nChunk;
+				}
+			}
+			return d == nDst;
+		}
+	}
 
-	const olc::vi2d& PixelGameEngine::GetWindowSize() const
-	{ return vWindowSize; }
+	// O------------------------------------------------------------------------------O
+	// | olc::ResourcePack IMPLEMENTATION                                             |
+	// O------------------------------------------------------------------------------O
 
-	const olc::vi2d& PixelGameEngine::GetPixelSize() const
-	{ return vPixelSize; }
 
-	const olc::vi2d& PixelGameEngine::GetScreenPixelSize() const
-	{ return vScreenPixelSize; }
+	//=============================================================
+	// Resource Packs - Allows you to store files in one large 
+	// scrambled file - Thanks MaGetzUb for debugging a null char in std::stringstream bug
+	ResourceBuffer::ResourceBuffer(const char* data, uint32_t size)
+	{
+		pMemory = data; nSize = size;
+		char* p = const_cast<char*>(data);
+		setg(p, p, p + size);
+	}
 
-	const olc::vi2d& PixelGameEngine::GetWindowMouse() const
-	{ return vMouseWindowPos; }
+	bool ResourceBuffer::Found() const
+	{ return pMemory != nullptr; }
 
+	ResourcePack::ResourcePack() { }
+	ResourcePack::~ResourcePack() { unload(); }
 
-	bool PixelGameEngine::Draw(const olc::vi2d& pos, Pixel p)
+	bool ResourcePack::AddFile(const std::string& sFile, bool bCompress)
 	{
-		return Draw(pos.x, pos.y, p);
+		const std::string file = makeposix(sFile);
+
+		if (_gfs::exists(file))
+		{
+			sResourceFile e;
+			e.nSize = (uint32_t)_gfs::file_size(file);
+			e.nOffset = 0; // Unknown at this stage			
+			e.bCompress = bCompress;
+			mapFiles[file] = std::move(e);
+			return true;
+		}
+		return false;
 	}
 
-	// This is it, the critical function that plots a pixel
-	bool PixelGameEngine::Draw(int32_t x, int32_t y, Pixel p)
+	bool ResourcePack::LoadPack(const std::string& sFile, const std::string& sKey, uint32_t nWorkers)
 	{
-		if (!pDrawTarget) return false;
+		const auto tpStart = std::chrono::steady_clock::now();
+		stats = sPackStats();
+
+		// Map the resource file, files are read from it in place
+		unload();
+		if (!baseFile.Open(sFile)) return false;
+		char* pFile = (char*)baseFile.Data();
+		const size_t nFileSize = baseFile.Size();
+
+		// 1) Unscramble the index where it lies, the mapping is private
+		uint32_t nIndexSize = 0;
+		if (nFileSize < sizeof(uint32_t)) { unload(); return false; }
+		memcpy(&nIndexSize, pFile, sizeof(uint32_t));
+		if (nIndexSize > nFileSize - sizeof(uint32_t)) { unload(); return false; }
+
+		const std::vector<uint8_t> vKeys = makekeystream(sKey);
+		char* pIndex = pFile + sizeof(uint32_t);
+		scramble(pIndex, nIndexSize, vKeys, 0);
+		bool bValid = true;
+		uint32_t nMapEntries = 0;
+		uint32_t nFlags = 0;
+		if (nIndexSize >= sizeof(uint32_t)) memcpy(&nMapEntries, pIndex, sizeof(uint32_t));
 
-		if (nPixelMode == Pixel::NORMAL)
+		// 2) A directory is used as it is. Legacy packs list each name and offset,
+		// so are read into a map once and laid out as a directory
+		if (nMapEntries & nDirectoryIndex)
 		{
-			return pDrawTarget->SetPixel(x, y, p);
+			bValid = opendirectory(pIndex, nIndexSize, nFileSize);
+			if (bValid) memcpy(&nFlags, pIndex + offsetof(sDirHeader, nFlags), sizeof(uint32_t));
 		}
-
-		if (nPixelMode == Pixel::MASK)
+		else
 		{
-			if (p.a == 255)
-				return pDrawTarget->SetPixel(x, y, p);
+			size_t pos = sizeof(uint32_t);
+			auto read = [pIndex, nIndexSize, &pos, &bValid](char* dst, size_t size) {
+				if (size > nIndexSize - pos) { bValid = false; memset(dst, 0, size); return; }
+				memcpy((void*)dst, (const void*)(pIndex + pos), size);
+				pos += size;
+			};
+
+			std::map<std::string, sResourceFile> mapLegacy;
+			for (uint32_t i = 0; i < nMapEntries && bValid; i++)
+			{
+				uint32_t nFilePathSize = 0;
+				read((char*)&nFilePathSize, sizeof(uint32_t));
+				if (nFilePathSize > nIndexSize - pos) { bValid = false; break; }
+
+				std::string sFileName(nFilePathSize, ' ');
+				read(&sFileName[0], nFilePathSize);
+
+				sResourceFile e;
+				uint32_t nOffset = 0;
+				read((char*)&e.nSize, sizeof(uint32_t));
+				read((char*)&nOffset, sizeof(uint32_t));
+				e.nOffset = nOffset;
+				e.nStoredSize = e.nSize;
+				if (bValid) mapLegacy[sFileName] = std::move(e);
+			}
+			if (bValid && mapLegacy.size() == nMapEntries) vDirectory = makedirectory(mapLegacy);
+			bValid = bValid && opendirectory(vDirectory.data(), vDirectory.size(), nFileSize);
 		}
 
-		if (nPixelMode == Pixel::ALPHA)
+		// Shares nJobs out between the workers, each taking the next job left until
+		// there are none
+		if (nWorkers == 0) nWorkers = std::max(1u, std::thread::hardware_concurrency());
+		auto RunWorkers = [nWorkers](size_t nJobs, const std::function<bool(size_t)>& Job)
 		{
-			Pixel d = pDrawTarget->GetPixel(x, y);
-			float a = (float)(p.a / 255.0f) * fBlendFactor;
-			float c = 1.0f - a;
-			float r = a * (float)p.r + c * (float)d.r;
-			float g = a * (float)p.g + c * (float)d.g;
-			float b = a * (float)p.b + c * (float)d.b;
-			return pDrawTarget->SetPixel(x, y, Pixel((uint8_t)r, (uint8_t)g, (uint8_t)b/*, (uint8_t)(p.a * fBlendFactor)*/));
-		}
+			std::atomic<size_t> nNext{ 0 };
+			std::atomic<bool> bDone{ true };
+			auto Work = [&]()
+			{
+				for (size_t i = nNext++; i < nJobs; i = nNext++)
+					if (!Job(i)) bDone = false;
+			};
+			std::vector<std::thread> vWorkers;
+			for (size_t i = 1; i < std::min<size_t>(nWorkers, nJobs); i++) vWorkers.emplace_back(Work);
+			Work();
+			for (auto& t : vWorkers) t.join();
+			return bool(bDone);
+		};
 
-		if (nPixelMode == Pixel::CUSTOM)
+		// 3) Everything after the index was scrambled from where it lies in the pack.
+		// It is unscrambled when read, only compressed files are read now
+		if (bValid && (nFlags & SCRAMBLED_FILES))
 		{
-			return pDrawTarget->SetPixel(x, y, funcPixelMode(x, y, p, pDrawTarget->GetPixel(x, y)));
+			nScrambledFrom = sizeof(uint32_t) + nIndexSize;
+			vKeystream = vKeys;
+			pBlockUnscrambled = std::make_unique<std::once_flag[]>((nFileSize - nScrambledFrom + nBlockSize - 1) / nBlockSize);
+			RunWorkers(nEntries, [&](size_t i)
+			{
+				const sDirEntry& e = pEntries[i];
+				if (e.nCompression != RAW) unscramble(uint64_t(e.nOffsetHi) << 32 | e.nOffsetLo, e.nStoredSize);
+				return true;
+			});
 		}
 
-		return false;
-	}
+		// 4) Unpack compressed files, finding every block first so that workers can
+		// share them out
+		struct sBlock { const uint8_t* pSrc; uint32_t nSrc; uint8_t* pDst; uint32_t nDst; };
+		std::vector<sBlock> vBlocks;
+		if (bValid) vUnpacked.resize(nEntries);
+		for (uint32_t i = 0; i < nEntries && bValid; i++)
+		{
+			const sDirEntry& e = pEntries[i];
+			stats.nFiles++;
+			stats.nFileBytes += e.nSize;
+			stats.nStoredBytes += e.nStoredSize;
+			if (e.nCompression == RAW) continue;
+			stats.nCompressed++;
+
+			vUnpacked[i].resize(e.nSize);
+			const uint8_t* pStored = baseFile.Data() + (uint64_t(e.nOffsetHi) << 32 | e.nOffsetLo);
+			uint32_t s = 0;
+			for (uint32_t nDone = 0; nDone < e.nSize && bValid; nDone += nBlockSize)
+			{
+				uint32_t nBlock = 0;
+				if (e.nStoredSize - s < sizeof(uint32_t)) { bValid = false; break; }
+				memcpy(&nBlock, pStored + s, sizeof(uint32_t));
+				s += sizeof(uint32_t);
+				if (nBlock > e.nStoredSize - s) { bValid = false; break; }
+				vBlocks.push_back({ pStored + s, nBlock, (uint8_t*)vUnpacked[i].data() + nDone, std::min(nBlockSize, e.nSize - nDone) });
+				s += nBlock;
+			}
+			if (s != e.nStoredSize) bValid = false;
+		}
+
+		if (bValid)
+		{
+			bValid = RunWorkers(vBlocks.size(), [&](size_t i)
+				{ return lz4::Decompress(vBlocks[i].pSrc, vBlocks[i].nSrc, vBlocks[i].pDst, vBlocks[i].nDst); });
+		}
 
+		// A damaged or wrongly keyed index is not trusted at all
+		if (!bValid)
+		{
+			unload();
+			stats = sPackStats();
+			return false;
+		}
 
-	void PixelGameEngine::DrawLine(const olc::vi2d& pos1, const olc::vi2d& pos2, Pixel p, uint32_t pattern)
-	{
-		DrawLine(pos1.x, pos1.y, pos2.x, pos2.y, p, pattern);
+		// Keep the mapping, files are views into it
+		stats.fSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - tpStart).count();
+		return true;
 	}
 
-	void PixelGameEngine::DrawLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, Pixel p, uint32_t pattern)
+	bool ResourcePack::SavePack(const std::string& sFile, const std::string& sKey, bool bScrambleFiles)
 	{
-		int x, y, dx, dy, dx1, dy1, px, py, xe, ye, i;
-		dx = x2 - x1; dy = y2 - y1;
+		const auto tpStart = std::chrono::steady_clock::now();
+		stats = sPackStats();
 
-		auto rol = [&](void) { pattern = (pattern << 1) | (pattern >> 31); return pattern & 1; };
+		// Create/Overwrite the resource file
+		std::ofstream ofs(sFile, std::ofstream::binary);
+		if (!ofs.is_open()) return false;
 
-		// straight lines idea by gurkanctn
-		if (dx == 0) // Line is vertical
+		// 1) Write a placeholder directory, to be rewritten once the offsets are known.
+		// It is the same size either way
+		const uint32_t nFlags = bScrambleFiles ? uint32_t(SCRAMBLED_FILES) : 0u;
+		const std::vector<char> vPlaceholder = makedirectory(mapFiles, nFlags);
+		const uint32_t nIndexStringLen = uint32_t(vPlaceholder.size());
+		ofs.write((char*)&nIndexStringLen, sizeof(uint32_t));
+		ofs.write(vPlaceholder.data(), nIndexStringLen);
+
+		// 2) Stream each file into the pack a block at a time, so memory use does
+		// not depend on the size of the files. Scrambled contents are scrambled from
+		// where they are written
+		const std::vector<uint8_t> vKeys = makekeystream(sKey);
+		std::vector<char> vBlock(nBlockSize);
+		std::vector<uint8_t> vPacked;
+		uint64_t offset = sizeof(uint32_t) + nIndexStringLen;
+		uint64_t nWritePos = offset;
+		auto Write = [&](char* data, uint32_t n)
 		{
-			if (y2 < y1) std::swap(y1, y2);
-			for (y = y1; y <= y2; y++) if (rol()) Draw(x1, y, p);
-			return;
-		}
-
-		if (dy == 0) // Line is horizontal
+			if (bScrambleFiles) scramble(data, n, vKeys, nWritePos);
+			ofs.write(data, n);
+			nWritePos += n;
+		};
+		for (auto& e : mapFiles)
 		{
-			if (x2 < x1) std::swap(x1, x2);
-			for (x = x1; x <= x2; x++) if (rol()) Draw(x, y1, p);
-			return;
-		}
+			sResourceFile& f = e.second;
+			f.nOffset = offset;
+			f.nCompression = RAW;
+			f.nStoredSize = f.nSize;
 
-		// Line is Funk-aye
-		dx1 = abs(dx); dy1 = abs(dy);
-		px = 2 * dy1 - dx1;	py = 2 * dx1 - dy1;
-		if (dy1 <= dx1)
-		{
-			if (dx >= 0)
+			std::ifstream i(e.first, std::ifstream::binary);
+			if (!i.is_open()) return false;
+			auto ReadBlock = [&](uint32_t nDone)
 			{
-				x = x1; y = y1; xe = x2;
-			}
-			else
+				const uint32_t n = std::min(nBlockSize, f.nSize - nDone);
+				i.read(vBlock.data(), n);
+				return uint32_t(i.gcount()) == n ? n : 0;
+			};
+
+			// Compressed files give up as soon as they are no smaller, and go back
+			// to be stored raw
+			if (f.bCompress)
 			{
-				x = x2; y = y2; xe = x1;
-			}
+				uint64_t nStored = 0;
+				for (uint32_t nDone = 0; nDone < f.nSize && nStored < f.nSize;)
+				{
+					const uint32_t n = ReadBlock(nDone);
+					if (n == 0) return false;
+					lz4::Compress((const uint8_t*)vBlock.data(), n, vPacked);
+					uint32_t nPacked = uint32_t(vPacked.size());
+					nStored += sizeof(uint32_t) + nPacked;
+					Write((char*)&nPacked, sizeof(uint32_t));
+					Write((char*)vPacked.data(), uint32_t(vPacked.size()));
+					nDone += n;
+				}
 
-			if (rol()) Draw(x, y, p);
+				if (nStored < f.nSize)
+				{
+					f.nCompression = LZ4;
+					f.nStoredSize = uint32_t(nStored);
+					stats.nCompressed++;
+				}
+				else
+				{
+					ofs.seekp(std::streamoff(f.nOffset));
+					nWritePos = f.nOffset;
+					i.clear(); i.seekg(0);
+				}
+			}
 
-			for (i = 0; x < xe; i++)
+			if (f.nCompression == RAW)
 			{
-				x = x + 1;
-				if (px < 0)
-					px = px + 2 * dy1;
-				else
+				for (uint32_t nDone = 0; nDone < f.nSize;)
 				{
-					if ((dx < 0 && dy < 0) || (dx > 0 && dy > 0)) y = y + 1; else y = y - 1;
-					px = px + 2 * (dy1 - dx1);
+					const uint32_t n = ReadBlock(nDone);
+					if (n == 0) return false;
+					Write(vBlock.data(), n);
+					nDone += n;
 				}
-				if (rol()) Draw(x, y, p);
 			}
+
+			stats.nFiles++;
+			stats.nFileBytes += f.nSize;
+			stats.nStoredBytes += f.nStoredSize;
+			offset += f.nStoredSize;
 		}
-		else
+
+		// 3) Scramble Index
+		std::vector<char> sIndexString = makedirectory(mapFiles, nFlags);
+		scramble(sIndexString.data(), sIndexString.size(), vKeys, 0);
+
+		// 4) Rewrite Map (it has been updated with offsets now)
+		// at start of file
+		ofs.seekp(0, std::ios::beg);
+		ofs.write((char*)&nIndexStringLen, sizeof(uint32_t));
+		ofs.write(sIndexString.data(), nIndexStringLen);
+		const bool bWritten = ofs.good();
+		ofs.close();
+
+		// A compressed file given up on last may have left its attempt past the end
+		if (!bWritten) return false;
+		std::error_code ec;
+		_gfs::resize_file(sFile, offset, ec);
+		stats.fSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - tpStart).count();
+		return !ec;
+	}
+
+	ResourceBuffer ResourcePack::GetFileBuffer(const std::string& sFile)
+	{
+		const sDirEntry* e = find(sFile);
+		if (e == nullptr) return ResourceBuffer();
+		if (e->nCompression != RAW) return ResourceBuffer(vUnpacked[e - pEntries].data(), e->nSize);
+		const uint64_t nOffset = uint64_t(e->nOffsetHi) << 32 | e->nOffsetLo;
+		unscramble(nOffset, e->nSize);
+		return ResourceBuffer((const char*)baseFile.Data() + nOffset, e->nSize);
+	}
+
+	void ResourcePack::Scramble(char* data, size_t n, const std::string& sKey, uint64_t nPos)
+	{ scramble(data, n, makekeystream(sKey), nPos); }
+
+	void ResourcePack::unscramble(uint64_t nOffset, uint64_t nSize)
+	{
+		// The index before nScrambledFrom was unscrambled by LoadPack()
+		if (pBlockUnscrambled == nullptr) return;
+		const uint64_t nBegin = std::max(nOffset, nScrambledFrom);
+		const uint64_t nEnd = nOffset + nSize;
+		if (nEnd <= nBegin) return;
+
+		// Entries may share a block, or be read by several threads at once, but each
+		// block is only ever unscrambled once
+		char* pFile = (char*)baseFile.Data();
+		const uint64_t nFileSize = baseFile.Size();
+		for (uint64_t b = (nBegin - nScrambledFrom) / nBlockSize; b <= (nEnd - 1 - nScrambledFrom) / nBlockSize; b++)
 		{
-			if (dy >= 0)
-			{
-				x = x1; y = y1; ye = y2;
-			}
-			else
+			std::call_once(pBlockUnscrambled[b], [&]()
 			{
-				x = x2; y = y2; ye = y1;
-			}
+				const uint64_t nAt = nScrambledFrom + b * nBlockSize;
+				scramble(pFile + nAt, size_t(std::min<uint64_t>(nBlockSize, nFileSize - nAt)), vKeystream, nAt);
+			});
+		}
+	}
 
-			if (rol()) Draw(x, y, p);
+	const ResourcePack::sPackStats& ResourcePack::Stats() const
+	{ return stats; }
 
-			for (i = 0; y < ye; i++)
+	bool ResourcePack::Loaded()
+	{ return baseFile.IsOpen(); }
+
+	const ResourcePack::sDirEntry* ResourcePack::find(const std::string& sFile) const
+	{
+		if (pBuckets == nullptr) return nullptr;
+		const uint32_t nHash = hashname(sFile.data(), sFile.size());
+		const uint32_t nBucket = nHash >> (32 - nBucketBits);
+		for (uint32_t i = pBuckets[nBucket]; i < pBuckets[nBucket + 1]; i++)
+		{
+			const sDirEntry& e = pEntries[i];
+			if (e.nHash == nHash && e.nNameLength == sFile.size() && memcmp(pNames + e.nName, sFile.data(), sFile.size()) == 0)
+				return &e;
+		}
+		return nullptr;
+	}
+
+	bool ResourcePack::opendirectory(const char* pDir, size_t nDir, uint64_t nFileSize)
+	{
+		sDirHeader h;
+		if (nDir < sizeof(sDirHeader)) return false;
+		memcpy(&h, pDir, sizeof(sDirHeader));
+		if (!(h.nCount & nDirectoryIndex) || h.nBucketBits < 1 || h.nBucketBits > 31) return false;
+		if (h.nFlags & ~uint32_t(SCRAMBLED_FILES)) return false;
+
+		const uint32_t nCount = h.nCount & ~nDirectoryIndex;
+		const uint64_t nBuckets = uint64_t(1) << h.nBucketBits;
+		const uint64_t nNamesAt = sizeof(sDirHeader) + (nBuckets + 1) * sizeof(uint32_t) + uint64_t(nCount) * sizeof(sDirEntry);
+		if (nNamesAt + h.nNameBytes != nDir) return false;
+
+		// Everything a lookup relies on is checked once here, so it need not be again
+		const uint32_t* pB = (const uint32_t*)(pDir + sizeof(sDirHeader));
+		const sDirEntry* pE = (const sDirEntry*)(pB + nBuckets + 1);
+		if (pB[0] != 0 || pB[nBuckets] != nCount) return false;
+		for (uint64_t b = 0; b < nBuckets; b++)
+		{
+			if (pB[b] > pB[b + 1]) return false;
+			for (uint32_t i = pB[b]; i < pB[b + 1]; i++)
 			{
-				y = y + 1;
-				if (py <= 0)
-					py = py + 2 * dx1;
-				else
-				{
-					if ((dx < 0 && dy < 0) || (dx > 0 && dy > 0)) x = x + 1; else x = x - 1;
-					py = py + 2 * (dx1 - dy1);
-				}
-				if (rol()) Draw(x, y, p);
+				const sDirEntry& e = pE[i];
+				const uint64_t nOffset = uint64_t(e.nOffsetHi) << 32 | e.nOffsetLo;
+				if (e.nHash >> (32 - h.nBucketBits) != b) return false;
+				if (e.nName > h.nNameBytes || e.nNameLength > h.nNameBytes - e.nName) return false;
+				if (nOffset > nFileSize || e.nStoredSize > nFileSize - nOffset) return false;
+				if (e.nCompression > LZ4 || (e.nCompression == RAW && e.nStoredSize != e.nSize)) return false;
+				if (e.nCompression == LZ4 && e.nSize == 0) return false;
 			}
 		}
+
+		pBuckets = pB;
+		pEntries = pE;
+		pNames = pDir + nNamesAt;
+		nEntries = nCount;
+		nBucketBits = h.nBucketBits;
+		return true;
 	}
 
-	void PixelGameEngine::DrawCircle(const olc::vi2d& pos, int32_t radius, Pixel p, uint8_t mask)
+	void ResourcePack::unload()
 	{
-		DrawCircle(pos.x, pos.y, radius, p, mask);
+		pBuckets = nullptr; pEntries = nullptr; pNames = nullptr;
+		nEntries = 0; nBucketBits = 0;
+		vDirectory.clear();
+		vUnpacked.clear();
+		vKeystream.clear();
+		pBlockUnscrambled.reset();
+		nScrambledFrom = 0;
+		baseFile.Close();
 	}
 
-	void PixelGameEngine::DrawCircle(int32_t x, int32_t y, int32_t radius, Pixel p, uint8_t mask)
-	{ // Thanks to IanM-Matrix1 #PR121
-		if (radius < 0 || x < -radius || y < -radius || x - GetDrawTargetWidth() > radius || y - GetDrawTargetHeight() > radius)
-			return;
-
-		if (radius > 0)
+	std::vector<char> ResourcePack::makedirectory(const std::map<std::string, sResourceFile>& files, uint32_t nFlags)
+	{
+		// At least as many buckets as files, so most hold one file or none
+		const uint32_t nCount = uint32_t(files.size());
+		uint32_t nBits = 1;
+		while (nBits < 31 && (uint64_t(1) << nBits) < nCount) nBits++;
+		const uint32_t nBuckets = 1u << nBits;
+
+		// Sort by hash, the map keeps files with the same hash in name order
+		std::vector<std::pair<uint32_t, const std::pair<const std::string, sResourceFile>*>> vSorted;
+		vSorted.reserve(nCount);
+		uint32_t nNameBytes = 0;
+		for (auto& e : files)
 		{
-			int x0 = 0;
-			int y0 = radius;
-			int d = 3 - 2 * radius;
+			vSorted.push_back({ hashname(e.first.data(), e.first.size()), &e });
+			nNameBytes += uint32_t(e.first.size());
+		}
+		std::stable_sort(vSorted.begin(), vSorted.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
 
-			while (y0 >= x0) // only formulate 1/8 of circle
-			{
-				// Draw even octants
-				if (mask & 0x01) Draw(x + x0, y - y0, p);// Q6 - upper right right
-				if (mask & 0x04) Draw(x + y0, y + x0, p);// Q4 - lower lower right
-				if (mask & 0x10) Draw(x - x0, y + y0, p);// Q2 - lower left left
-				if (mask & 0x40) Draw(x - y0, y - x0, p);// Q0 - upper upper left
-				if (x0 != 0 && x0 != y0)
-				{
-					if (mask & 0x02) Draw(x + y0, y - x0, p);// Q7 - upper upper right
-					if (mask & 0x08) Draw(x + x0, y + y0, p);// Q5 - lower right right
-					if (mask & 0x20) Draw(x - y0, y + x0, p);// Q3 - lower lower left
-					if (mask & 0x80) Draw(x - x0, y - y0, p);// Q1 - upper left left
-				}
+		const size_t nEntriesAt = sizeof(sDirHeader) + (size_t(nBuckets) + 1) * sizeof(uint32_t);
+		const size_t nNamesAt = nEntriesAt + size_t(nCount) * sizeof(sDirEntry);
+		std::vector<char> d(nNamesAt + nNameBytes);
 
-				if (d < 0)
-					d += 4 * x0++ + 6;
-				else
-					d += 4 * (x0++ - y0--) + 10;
+		const sDirHeader h = { nCount | nDirectoryIndex, nBits, nNameBytes, nFlags };
+		memcpy(d.data(), &h, sizeof(sDirHeader));
+
+		uint32_t i = 0, nName = 0;
+		for (uint32_t b = 0; b <= nBuckets; b++)
+		{
+			memcpy(d.data() + sizeof(sDirHeader) + b * sizeof(uint32_t), &i, sizeof(uint32_t));
+			for (; i < nCount && (vSorted[i].first >> (32 - nBits)) == b; i++)
+			{
+				const std::string& sName = vSorted[i].second->first;
+				const sResourceFile& f = vSorted[i].second->second;
+				const sDirEntry e = { vSorted[i].first, nName, uint32_t(sName.size()), f.nSize,
+					uint32_t(f.nOffset), uint32_t(f.nOffset >> 32), f.nStoredSize, f.nCompression };
+				memcpy(d.data() + nEntriesAt + i * sizeof(sDirEntry), &e, sizeof(sDirEntry));
+				memcpy(d.data() + nNamesAt + nName, sName.data(), sName.size());
+				nName += uint32_t(sName.size());
 			}
 		}
-		else
-			Draw(x, y, p);
+		return d;
 	}
 
-	void PixelGameEngine::FillCircle(const olc::vi2d& pos, int32_t radius, Pixel p)
+	uint32_t ResourcePack::hashname(const char* s, size_t n)
 	{
-		FillCircle(pos.x, pos.y, radius, p);
+		// FNV-1a
+		uint32_t h = 2166136261u;
+		for (size_t i = 0; i < n; i++) h = (h ^ uint8_t(s[i])) * 16777619u;
+		return h;
 	}
 
-	void PixelGameEngine::FillCircle(int32_t x, int32_t y, int32_t radius, Pixel p)
-	{ // Thanks to IanM-Matrix1 #PR121
-		if (radius < 0 || x < -radius || y < -radius || x - GetDrawTargetWidth() > radius || y - GetDrawTargetHeight() > radius)
-			return;
+	std::vector<uint8_t> ResourcePack::makekeystream(const std::string& key)
+	{
+		if (key.empty()) return {};
+		const size_t nPeriod = key.size() * ((64 + key.size() - 1) / key.size());
+		std::vector<uint8_t> vKeys(nPeriod + 64);
+		for (size_t i = 0; i < vKeys.size(); i++) vKeys[i] = uint8_t(key[i % key.size()]);
+		return vKeys;
+	}
 
-		if (radius > 0)
+	void ResourcePack::scramble(char* data, size_t n, const std::vector<uint8_t>& keystream, uint64_t nPos)
+	{
+		if (keystream.empty()) return;
+
+		// The period is a whole number of keys no shorter than 64 bytes, so stepping
+		// 64 bytes on never has to wrap more than once
+		const size_t nPeriod = keystream.size() - 64;
+		size_t k = size_t(nPos % nPeriod);
+		uint8_t* p = (uint8_t*)data;
+		const uint8_t* pKeys = keystream.data();
+		size_t i = 0;
+		for (; i + 64 <= n; i += 64)
 		{
-			int x0 = 0;
-			int y0 = radius;
-			int d = 3 - 2 * radius;
-
-			auto drawline = [&](int sx, int ex, int y)
+#if defined(PGE_SIMD_AVX2)
+			for (size_t j = 0; j < 64; j += 32)
 			{
-				for (int x = sx; x <= ex; x++)
-					Draw(x, y, p);
-			};
-
-			while (y0 >= x0)
+				const __m256i d = _mm256_loadu_si256((const __m256i*)(p + i + j));
+				_mm256_storeu_si256((__m256i*)(p + i + j), _mm256_xor_si256(d, _mm256_loadu_si256((const __m256i*)(pKeys + k + j))));
+			}
+#elif defined(PGE_SIMD_SSE2)
+			for (size_t j = 0; j < 64; j += 16)
 			{
-				drawline(x - y0, x + y0, y - x0);
-				if (x0 > 0)	drawline(x - y0, x + y0, y + x0);
-
-				if (d < 0)
-					d += 4 * x0++ + 6;
-				else
-				{
-					if (x0 != y0)
-					{
-						drawline(x - x0, x + x0, y - y0);
-						drawline(x - x0, x + x0, y + y0);
-					}
-					d += 4 * (x0++ - y0--) + 10;
-				}
+				const __m128i d = _mm_loadu_si128((const __m128i*)(p + i + j));
+				_mm_storeu_si128((__m128i*)(p + i + j), _mm_xor_si128(d, _mm_loadu_si128((const __m128i*)(pKeys + k + j))));
+			}
+#else
+			for (size_t j = 0; j < 64; j += 8)
+			{
+				uint64_t d, x;
+				memcpy(&d, p + i + j, 8); memcpy(&x, pKeys + k + j, 8);
+				d ^= x; memcpy(p + i + j, &d, 8);
 			}
+#endif
+			k += 64;
+			if (k >= nPeriod) k -= nPeriod;
+		}
+
+		for (; i < n; i++)
+		{
+			p[i] ^= pKeys[k];
+			if (++k == nPeriod) k = 0;
 		}
-		else
-			Draw(x, y, p);
 	}
 
-	void PixelGameEngine::DrawRect(const olc::vi2d& pos, const olc::vi2d& size, Pixel p)
+	std::string ResourcePack::makeposix(const std::string& path)
 	{
-		DrawRect(pos.x, pos.y, size.x, size.y, p);
+		std::string o;
+		for (auto s : path) o += std::string(1, s == '\\' ? '/' : s);
+		return o;
+	};
+
+	// O------------------------------------------------------------------------------O
+	// | olc::FrameProfiler IMPLEMENTATION                                            |
+	// O------------------------------------------------------------------------------O
+	void ProfileRing::Push(float f)
+	{
+		const uint32_t n = nHead.load(std::memory_order_relaxed);
+		samples[n % nCapacity].store(f, std::memory_order_relaxed);
+		nHead.store(n + 1, std::memory_order_release);
 	}
 
-	void PixelGameEngine::DrawRect(int32_t x, int32_t y, int32_t w, int32_t h, Pixel p)
+	void ProfileRing::Read(std::vector<float>& vOut) const
 	{
-		DrawLine(x, y, x + w, y, p);
-		DrawLine(x + w, y, x + w, y + h, p);
-		DrawLine(x + w, y + h, x, y + h, p);
-		DrawLine(x, y + h, x, y, p);
+		const uint32_t n = nHead.load(std::memory_order_acquire);
+		const uint32_t nCount = std::min(n, nCapacity);
+		vOut.resize(nCount);
+		for (uint32_t i = 0; i < nCount; i++)
+			vOut[i] = samples[(n - nCount + i) % nCapacity].load(std::memory_order_relaxed);
 	}
 
-	void PixelGameEngine::Clear(Pixel p)
+	uint32_t FrameProfiler::Scope(const std::string& sName)
 	{
-		int pixels = GetDrawTargetWidth() * GetDrawTargetHeight();
-		Pixel* m = GetDrawTarget()->GetData();
-		for (int i = 0; i < pixels; i++) m[i] = p;
+		std::lock_guard<std::mutex> lock(muxScopes);
+		const uint32_t n = nScopes.load();
+		for (uint32_t i = 0; i < n; i++)
+			if (sScopeNames[i] == sName) return i;
+		if (n == nMaxScopes) return nMaxScopes;
+		sScopeNames[n] = sName;
+		nScopes.store(n + 1);
+		return n;
 	}
 
-	void PixelGameEngine::ClearBuffer(Pixel p, bool bDepth)
+	void FrameProfiler::AddTime(uint32_t nScope, float fSeconds)
 	{
-		renderer->ClearBuffer(p, bDepth);
+		if (nScope < nMaxScopes)
+			nScopeNanoseconds[nScope].fetch_add(uint64_t(fSeconds * 1e9f), std::memory_order_relaxed);
 	}
 
-	void PixelGameEngine::FillRect(const olc::vi2d& pos, const olc::vi2d& size, Pixel p)
+	void FrameProfiler::EndFrame(const float* pPhaseSeconds)
 	{
-		FillRect(pos.x, pos.y, size.x, size.y, p);
+		for (uint32_t i = 0; i < PHASES; i++) rings[i].Push(pPhaseSeconds[i]);
+		const uint32_t n = nScopes.load();
+		for (uint32_t i = 0; i < n; i++)
+			rings[PHASES + i].Push(float(nScopeNanoseconds[i].exchange(0, std::memory_order_relaxed)) * 1e-9f);
 	}
 
-	void PixelGameEngine::FillRect(int32_t x, int32_t y, int32_t w, int32_t h, Pixel p)
+	uint32_t FrameProfiler::SeriesCount() const
+	{ return PHASES + nScopes.load(); }
+
+	const char* FrameProfiler::PhaseName(uint32_t nPhase)
 	{
-		int32_t x2 = x + w;
-		int32_t y2 = y + h;
+		static const char* sPhaseNames[PHASES] = { "Events", "Input", "Update", "Upload", "Draw", "Display" };
+		return nPhase < PHASES ? sPhaseNames[nPhase] : "";
+	}
 
-		if (x < 0) x = 0;
-		if (x >= (int32_t)GetDrawTargetWidth()) x = (int32_t)GetDrawTargetWidth();
-		if (y < 0) y = 0;
-		if (y >= (int32_t)GetDrawTargetHeight()) y = (int32_t)GetDrawTargetHeight();
+	std::string FrameProfiler::SeriesName(uint32_t nSeries) const
+	{
+		if (nSeries < PHASES) return PhaseName(nSeries);
+		std::lock_guard<std::mutex> lock(muxScopes);
+		return nSeries - PHASES < nScopes.load() ? sScopeNames[nSeries - PHASES] : std::string();
+	}
 
-		if (x2 < 0) x2 = 0;
-		if (x2 >= (int32_t)GetDrawTargetWidth()) x2 = (int32_t)GetDrawTargetWidth();
-		if (y2 < 0) y2 = 0;
-		if (y2 >= (int32_t)GetDrawTargetHeight()) y2 = (int32_t)GetDrawTargetHeight();
+	float FrameProfiler::Percentile(uint32_t nSeries, float p) const
+	{
+		if (nSeries >= SeriesCount()) return 0.0f;
+		std::vector<float> v;
+		rings[nSeries].Read(v);
+		if (v.empty()) return 0.0f;
+		const size_t n = std::min(v.size() - 1, size_t(p * float(v.size())));
+		std::nth_element(v.begin(), v.begin() + n, v.end());
+		return v[n];
+	}
+
+	std::atomic<uint32_t> TraceLog::nNextLog{ 0 };
+
+	TraceLog::TraceLog() : nLog(nNextLog++), tpOrigin(std::chrono::steady_clock::now())
+	{ }
 
-		for (int i = x; i < x2; i++)
-			for (int j = y; j < y2; j++)
-				Draw(i, j, p);
+	TraceLog::ThreadBuffer& TraceLog::Local()
+	{
+		// Each thread remembers its buffer in the last log it recorded into
+		thread_local uint32_t nCachedLog = UINT32_MAX;
+		thread_local ThreadBuffer* pCached = nullptr;
+		if (nCachedLog != nLog)
+		{
+			std::lock_guard<std::mutex> lock(muxLog);
+			listBuffers.emplace_back();
+			listBuffers.back().nThread = uint32_t(listBuffers.size());
+			pCached = &listBuffers.back();
+			nCachedLog = nLog;
+		}
+		return *pCached;
 	}
 
-	void PixelGameEngine::DrawTriangle(const olc::vi2d& pos1, const olc::vi2d& pos2, const olc::vi2d& pos3, Pixel p)
+	void TraceLog::Record(const Event& e)
 	{
-		DrawTriangle(pos1.x, pos1.y, pos2.x, pos2.y, pos3.x, pos3.y, p);
+		ThreadBuffer& b = Local();
+		std::lock_guard<std::mutex> lock(b.mux);
+		if (b.vecEvents.size() < nMaxEventsPerThread) b.vecEvents.push_back(e); else b.nDropped++;
 	}
 
-	void PixelGameEngine::DrawTriangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p)
+	void TraceLog::Complete(const char* sName, std::chrono::steady_clock::time_point tpStart, std::chrono::steady_clock::time_point tpEnd)
 	{
-		DrawLine(x1, y1, x2, y2, p);
-		DrawLine(x2, y2, x3, y3, p);
-		DrawLine(x3, y3, x1, y1, p);
+		using namespace std::chrono;
+		// Spans already under way when the log was made start with it
+		tpStart = std::max(tpStart, tpOrigin);
+		Record({ sName, 'X', duration_cast<nanoseconds>(tpStart - tpOrigin).count(), duration_cast<nanoseconds>(std::max(tpEnd, tpStart) - tpStart).count() });
 	}
 
-	void PixelGameEngine::FillTriangle(const olc::vi2d& pos1, const olc::vi2d& pos2, const olc::vi2d& pos3, Pixel p)
+	void TraceLog::Instant(const char* sName)
 	{
-		FillTriangle(pos1.x, pos1.y, pos2.x, pos2.y, pos3.x, pos3.y, p);
+		using namespace std::chrono;
+		Record({ sName, 'i', duration_cast<nanoseconds>(steady_clock::now() - tpOrigin).count(), 0 });
 	}
 
-	// https://www.avrfreaks.net/sites/default/files/triangles.c
-	void PixelGameEngine::FillTriangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p)
+	void TraceLog::SetThreadName(const std::string& sName)
 	{
-		auto drawline = [&](int sx, int ex, int ny) { for (int i = sx; i <= ex; i++) Draw(i, ny, p); };
+		ThreadBuffer& b = Local();
+		std::lock_guard<std::mutex> lock(b.mux);
+		b.sName = sName;
+	}
 
-		int t1x, t2x, y, minx, maxx, t1xp, t2xp;
-		bool changed1 = false;
-		bool changed2 = false;
-		int signx1, signx2, dx1, dy1, dx2, dy2;
-		int e1, e2;
-		// Sort vertices
-		if (y1 > y2) { std::swap(y1, y2); std::swap(x1, x2); }
-		if (y1 > y3) { std::swap(y1, y3); std::swap(x1, x3); }
-		if (y2 > y3) { std::swap(y2, y3); std::swap(x2, x3); }
-
-		t1x = t2x = x1; y = y1;   // Starting points
-		dx1 = (int)(x2 - x1);
-		if (dx1 < 0) { dx1 = -dx1; signx1 = -1; }
-		else signx1 = 1;
-		dy1 = (int)(y2 - y1);
-
-		dx2 = (int)(x3 - x1);
-		if (dx2 < 0) { dx2 = -dx2; signx2 = -1; }
-		else signx2 = 1;
-		dy2 = (int)(y3 - y1);
-
-		if (dy1 > dx1) { std::swap(dx1, dy1); changed1 = true; }
-		if (dy2 > dx2) { std::swap(dy2, dx2); changed2 = true; }
+	const char* TraceLog::Name(const std::string& sName)
+	{
+		std::lock_guard<std::mutex> lock(muxLog);
+		return mapNames.emplace(sName, true).first->first.c_str();
+	}
 
-		e2 = (int)(dx2 >> 1);
-		// Flat top, just process the second half
-		if (y1 == y2) goto next;
-		e1 = (int)(dx1 >> 1);
+	olc::rcode TraceLog::Save(const std::string& sFile)
+	{
+		std::ofstream ofs(sFile, std::ios::out | std::ios::trunc);
+		if (!ofs.is_open()) return olc::FAIL;
 
-		for (int i = 0; i < dx1;) {
-			t1xp = 0; t2xp = 0;
-			if (t1x < t2x) { minx = t1x; maxx = t2x; }
-			else { minx = t2x; maxx = t1x; }
-			// process first line until y value is about to change
-			while (i < dx1) {
-				i++;
-				e1 += dy1;
-				while (e1 >= dx1) {
-					e1 -= dx1;
-					if (changed1) t1xp = signx1;//t1x += signx1;
-					else          goto next1;
-				}
-				if (changed1) break;
-				else t1x += signx1;
-			}
-			// Move line
-		next1:
-			// process second line until y value is about to change
-			while (1) {
-				e2 += dy2;
-				while (e2 >= dx2) {
-					e2 -= dx2;
-					if (changed2) t2xp = signx2;//t2x += signx2;
-					else          goto next2;
-				}
-				if (changed2)     break;
-				else              t2x += signx2;
+		// Names come from user code, so escape them as JSON strings
+		auto Escape = [](const std::string& s)
+		{
+			std::string r;
+			for (const char c : s)
+			{
+				if (c == '"' || c == '\\') { r += '\\'; r += c; }
+				else if (uint8_t(c) < 0x20) { r += "\\u00"; r += "0123456789abcdef"[c >> 4]; r += "0123456789abcdef"[c & 15]; }
+				else r += c;
 			}
-		next2:
-			if (minx > t1x) minx = t1x;
-			if (minx > t2x) minx = t2x;
-			if (maxx < t1x) maxx = t1x;
-			if (maxx < t2x) maxx = t2x;
-			drawline(minx, maxx, y);    // Draw line from min to max points found on the y
-										// Now increase y
-			if (!changed1) t1x += signx1;
-			t1x += t1xp;
-			if (!changed2) t2x += signx2;
-			t2x += t2xp;
-			y += 1;
-			if (y == y2) break;
-
-		}
-	next:
-		// Second half
-		dx1 = (int)(x3 - x2); if (dx1 < 0) { dx1 = -dx1; signx1 = -1; }
-		else signx1 = 1;
-		dy1 = (int)(y3 - y2);
-		t1x = x2;
-
-		if (dy1 > dx1) {   // swap values
-			std::swap(dy1, dx1);
-			changed1 = true;
-		}
-		else changed1 = false;
-
-		e1 = (int)(dx1 >> 1);
+			return r;
+		};
+		auto Microseconds = [](int64_t ns) { return std::to_string(ns / 1000) + "." + std::to_string(1000 + ns % 1000).substr(1); };
 
-		for (int i = 0; i <= dx1; i++) {
-			t1xp = 0; t2xp = 0;
-			if (t1x < t2x) { minx = t1x; maxx = t2x; }
-			else { minx = t2x; maxx = t1x; }
-			// process first line until y value is about to change
-			while (i < dx1) {
-				e1 += dy1;
-				while (e1 >= dx1) {
-					e1 -= dx1;
-					if (changed1) { t1xp = signx1; break; }//t1x += signx1;
-					else          goto next3;
-				}
-				if (changed1) break;
-				else   	   	  t1x += signx1;
-				if (i < dx1) i++;
+		ofs << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		bool bFirst = true;
+		std::lock_guard<std::mutex> lockLog(muxLog);
+		for (auto& b : listBuffers)
+		{
+			std::lock_guard<std::mutex> lock(b.mux);
+			const std::string sThread = ",\"pid\":1,\"tid\":" + std::to_string(b.nThread);
+			if (!b.sName.empty())
+			{
+				ofs << (bFirst ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\"" << sThread << ",\"args\":{\"name\":\"" << Escape(b.sName) << "\"}}";
+				bFirst = false;
 			}
-		next3:
-			// process second line until y value is about to change
-			while (t2x != x3) {
-				e2 += dy2;
-				while (e2 >= dx2) {
-					e2 -= dx2;
-					if (changed2) t2xp = signx2;
-					else          goto next4;
-				}
-				if (changed2)     break;
-				else              t2x += signx2;
+			for (const auto& e : b.vecEvents)
+			{
+				ofs << (bFirst ? "" : ",\n") << "{\"name\":\"" << Escape(e.sName) << "\",\"ph\":\"" << e.cPhase << "\",\"ts\":" << Microseconds(e.nStart);
+				if (e.cPhase == 'X') ofs << ",\"dur\":" << Microseconds(e.nDuration); else ofs << ",\"s\":\"t\"";
+				ofs << sThread << "}";
+				bFirst = false;
 			}
-		next4:
-
-			if (minx > t1x) minx = t1x;
-			if (minx > t2x) minx = t2x;
-			if (maxx < t1x) maxx = t1x;
-			if (maxx < t2x) maxx = t2x;
-			drawline(minx, maxx, y);
-			if (!changed1) t1x += signx1;
-			t1x += t1xp;
-			if (!changed2) t2x += signx2;
-			t2x += t2xp;
-			y += 1;
-			if (y > y3) return;
+			if (b.nDropped > 0)
+				std::cout << "Trace: " << b.nDropped << " events dropped on thread " << b.nThread << std::endl;
 		}
+		ofs << "\n]}\n";
+		return ofs.good() ? olc::OK : olc::FAIL;
 	}
 
-	void PixelGameEngine::DrawSprite(const olc::vi2d& pos, Sprite* sprite, uint32_t scale, uint8_t flip)
+	ProfileScope::ProfileScope(olc::PixelGameEngine* pge, const std::string& sName)
 	{
-		DrawSprite(pos.x, pos.y, sprite, scale, flip);
+		pProfiler = pge->GetProfiler();
+		pTrace = pge->GetTrace();
+		if (pProfiler != nullptr) nScope = pProfiler->Scope(sName);
+		if (pTrace != nullptr) sTraceName = pTrace->Name(sName);
+		tpStart = std::chrono::steady_clock::now();
 	}
 
-	void PixelGameEngine::DrawSprite(int32_t x, int32_t y, Sprite* sprite, uint32_t scale, uint8_t flip)
+	ProfileScope::~ProfileScope()
 	{
-		if (sprite == nullptr)
-			return;
+		if (pProfiler == nullptr && pTrace == nullptr) return;
+		const auto tpEnd = std::chrono::steady_clock::now();
+		if (pProfiler != nullptr) pProfiler->AddTime(nScope, std::chrono::duration<float>(tpEnd - tpStart).count());
+		if (pTrace != nullptr) pTrace->Complete(sTraceName, tpStart, tpEnd);
+	}
 
-		int32_t fxs = 0, fxm = 1, fx = 0;
-		int32_t fys = 0, fym = 1, fy = 0;
-		if (flip & olc::Sprite::Flip::HORIZ) { fxs = sprite->width - 1; fxm = -1; }
-		if (flip & olc::Sprite::Flip::VERT) { fys = sprite->height - 1; fym = -1; }
+	// O------------------------------------------------------------------------------O
+	// | olc::span IMPLEMENTATION - row kernels, SIMD where the target has it         |
+	// O------------------------------------------------------------------------------O
+	namespace span
+	{
+		void Fill(olc::Pixel* dst, int32_t n, olc::Pixel p)
+		{
+			int32_t i = 0;
+#if defined(PGE_SIMD_AVX2)
+			const __m256i v8 = _mm256_set1_epi32(int(p.n));
+			for (; i + 8 <= n; i += 8) _mm256_storeu_si256((__m256i*)(dst + i), v8);
+#endif
+#if defined(PGE_SIMD_SSE2)
+			const __m128i v4 = _mm_set1_epi32(int(p.n));
+			for (; i + 4 <= n; i += 4) _mm_storeu_si128((__m128i*)(dst + i), v4);
+#endif
+			for (; i < n; i++) dst[i] = p;
+		}
 
-		if (scale > 1)
+		// Alpha is reduced to 8 bits, and each channel is s*a + d*(255-a) divided
+		// by 255 in integers. That stays within 1 of the float path in Draw()
+		static inline uint32_t BlendAlpha(uint32_t a, float fBlend)
 		{
-			fx = fxs;
-			for (int32_t i = 0; i < sprite->width; i++, fx += fxm)
-			{
-				fy = fys;
-				for (int32_t j = 0; j < sprite->height; j++, fy += fym)
-					for (uint32_t is = 0; is < scale; is++)
-						for (uint32_t js = 0; js < scale; js++)
-							Draw(x + (i * scale) + is, y + (j * scale) + js, sprite->GetPixel(fx, fy));
-			}
+			const uint32_t b = uint32_t(std::max(0.0f, std::min(fBlend, 1.0f)) * 256.0f + 0.5f);
+			return std::min((a * b + 128) >> 8, 255u);
 		}
-		else
+
+		static inline uint32_t Div255(uint32_t t)
+		{
+			return (t + 1 + (t >> 8)) >> 8;
+		}
+
+		void FillBlend(olc::Pixel* dst, int32_t n, olc::Pixel p, float fBlend)
 		{
-			fx = fxs;
-			for (int32_t i = 0; i < sprite->width; i++, fx += fxm)
+			const uint32_t a = BlendAlpha(p.a, fBlend);
+			const uint32_t r = p.r * a, g = p.g * a, b = p.b * a, c = 255 - a;
+			int32_t i = 0;
+#if defined(PGE_SIMD_AVX2)
+			const __m256i vSrc8 = _mm256_set_epi16(0, short(b), short(g), short(r), 0, short(b), short(g), short(r),
+				0, short(b), short(g), short(r), 0, short(b), short(g), short(r));
+			const __m256i vInv8 = _mm256_set1_epi16(short(c));
+			const __m256i vOne8 = _mm256_set1_epi16(1);
+			const __m256i vOpaque8 = _mm256_set1_epi32(int(0xFF000000));
+			const __m256i vZero8 = _mm256_setzero_si256();
+			for (; i + 8 <= n; i += 8)
+			{
+				__m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+				__m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, vZero8), vInv8), vSrc8);
+				__m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, vZero8), vInv8), vSrc8);
+				lo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(lo, vOne8), _mm256_srli_epi16(lo, 8)), 8);
+				hi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(hi, vOne8), _mm256_srli_epi16(hi, 8)), 8);
+				_mm256_storeu_si256((__m256i*)(dst + i), _mm256_or_si256(_mm256_packus_epi16(lo, hi), vOpaque8));
+			}
+#endif
+#if defined(PGE_SIMD_SSE2)
+			// Two pixels per 128 bits once widened to 16 bit channels. Alpha is
+			// forced to 255 afterwards, so results are opaque like Draw()
+			const __m128i vSrc = _mm_set_epi16(0, short(b), short(g), short(r), 0, short(b), short(g), short(r));
+			const __m128i vInv = _mm_set1_epi16(short(c));
+			const __m128i vOne = _mm_set1_epi16(1);
+			const __m128i vOpaque = _mm_set1_epi32(int(0xFF000000));
+			const __m128i vZero = _mm_setzero_si128();
+			for (; i + 4 <= n; i += 4)
+			{
+				__m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+				__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, vZero), vInv), vSrc);
+				__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, vZero), vInv), vSrc);
+				lo = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(lo, vOne), _mm_srli_epi16(lo, 8)), 8);
+				hi = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(hi, vOne), _mm_srli_epi16(hi, 8)), 8);
+				_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_packus_epi16(lo, hi), vOpaque));
+			}
+#endif
+			for (; i < n; i++)
 			{
-				fy = fys;
-				for (int32_t j = 0; j < sprite->height; j++, fy += fym)
-					Draw(x + i, y + j, sprite->GetPixel(fx, fy));
+				const olc::Pixel d = dst[i];
+				dst[i] = olc::Pixel(uint8_t(Div255(r + d.r * c)), uint8_t(Div255(g + d.g * c)), uint8_t(Div255(b + d.b * c)));
 			}
 		}
-	}
-
-	void PixelGameEngine::DrawPartialSprite(const olc::vi2d& pos, Sprite* sprite, const olc::vi2d& sourcepos, const olc::vi2d& size, uint32_t scale, uint8_t flip)
-	{
-		DrawPartialSprite(pos.x, pos.y, sprite, sourcepos.x, sourcepos.y, size.x, size.y, scale, flip);
-	}
-
-	void PixelGameEngine::DrawPartialSprite(int32_t x, int32_t y, Sprite* sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, uint32_t scale, uint8_t flip)
-	{
-		if (sprite == nullptr)
-			return;
 
-		int32_t fxs = 0, fxm = 1, fx = 0;
-		int32_t fys = 0, fym = 1, fy = 0;
-		if (flip & olc::Sprite::Flip::HORIZ) { fxs = w - 1; fxm = -1; }
-		if (flip & olc::Sprite::Flip::VERT) { fys = h - 1; fym = -1; }
+		void Copy(olc::Pixel* dst, const olc::Pixel* src, int32_t n)
+		{
+			std::memcpy(dst, src, size_t(n) * sizeof(olc::Pixel));
+		}
 
-		if (scale > 1)
+		void Mask(olc::Pixel* dst, const olc::Pixel* src, int32_t n)
 		{
-			fx = fxs;
-			for (int32_t i = 0; i < w; i++, fx += fxm)
+			int32_t i = 0;
+#if defined(PGE_SIMD_AVX2)
+			const __m256i vAlpha8 = _mm256_set1_epi32(int(0xFF000000));
+			for (; i + 8 <= n; i += 8)
+			{
+				const __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+				const __m256i m = _mm256_cmpeq_epi32(_mm256_and_si256(s, vAlpha8), vAlpha8);
+				const __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+				_mm256_storeu_si256((__m256i*)(dst + i), _mm256_blendv_epi8(d, s, m));
+			}
+#endif
+#if defined(PGE_SIMD_SSE2)
+			const __m128i vAlpha4 = _mm_set1_epi32(int(0xFF000000));
+			for (; i + 4 <= n; i += 4)
 			{
-				fy = fys;
-				for (int32_t j = 0; j < h; j++, fy += fym)
-					for (uint32_t is = 0; is < scale; is++)
-						for (uint32_t js = 0; js < scale; js++)
-							Draw(x + (i * scale) + is, y + (j * scale) + js, sprite->GetPixel(fx + ox, fy + oy));
+				const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+				const __m128i m = _mm_cmpeq_epi32(_mm_and_si128(s, vAlpha4), vAlpha4);
+				const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+				_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(m, s), _mm_andnot_si128(m, d)));
 			}
+#endif
+			for (; i < n; i++)
+				if (src[i].a == 255) dst[i] = src[i];
 		}
-		else
+
+		void Blend(olc::Pixel* dst, const olc::Pixel* src, int32_t n, float fBlend)
 		{
-			fx = fxs;
-			for (int32_t i = 0; i < w; i++, fx += fxm)
+			const uint32_t b = uint32_t(std::max(0.0f, std::min(fBlend, 1.0f)) * 256.0f + 0.5f);
+			int32_t i = 0;
+#if defined(PGE_SIMD_AVX2)
+			const __m256i vBlend8 = _mm256_set1_epi16(short(b));
+			const __m256i vHalf8 = _mm256_set1_epi16(128);
+			const __m256i v2558 = _mm256_set1_epi16(255);
+			const __m256i vOne8 = _mm256_set1_epi16(1);
+			const __m256i vOpaque8 = _mm256_set1_epi32(int(0xFF000000));
+			const __m256i vZero8 = _mm256_setzero_si256();
+			auto BlendHalf8 = [&](__m256i s, __m256i d)
+			{
+				__m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+				a = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(a, vBlend8), vHalf8), 8);
+				__m256i t = _mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, _mm256_sub_epi16(v2558, a)));
+				return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(t, vOne8), _mm256_srli_epi16(t, 8)), 8);
+			};
+			// Unpacking and packing both work within 128 bit lanes, so pixel order is kept
+			for (; i + 8 <= n; i += 8)
+			{
+				const __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+				const __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+				const __m256i lo = BlendHalf8(_mm256_unpacklo_epi8(s, vZero8), _mm256_unpacklo_epi8(d, vZero8));
+				const __m256i hi = BlendHalf8(_mm256_unpackhi_epi8(s, vZero8), _mm256_unpackhi_epi8(d, vZero8));
+				_mm256_storeu_si256((__m256i*)(dst + i), _mm256_or_si256(_mm256_packus_epi16(lo, hi), vOpaque8));
+			}
+#endif
+#if defined(PGE_SIMD_SSE2)
+			// As FillBlend, but each pixel brings its own alpha, spread across its channels
+			const __m128i vBlend = _mm_set1_epi16(short(b));
+			const __m128i vHalf = _mm_set1_epi16(128);
+			const __m128i v255 = _mm_set1_epi16(255);
+			const __m128i vOne = _mm_set1_epi16(1);
+			const __m128i vOpaque = _mm_set1_epi32(int(0xFF000000));
+			const __m128i vZero = _mm_setzero_si128();
+			auto BlendHalf = [&](__m128i s, __m128i d)
+			{
+				__m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+				a = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(a, vBlend), vHalf), 8);
+				__m128i t = _mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, _mm_sub_epi16(v255, a)));
+				return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(t, vOne), _mm_srli_epi16(t, 8)), 8);
+			};
+			for (; i + 4 <= n; i += 4)
+			{
+				const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+				const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+				const __m128i lo = BlendHalf(_mm_unpacklo_epi8(s, vZero), _mm_unpacklo_epi8(d, vZero));
+				const __m128i hi = BlendHalf(_mm_unpackhi_epi8(s, vZero), _mm_unpackhi_epi8(d, vZero));
+				_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_packus_epi16(lo, hi), vOpaque));
+			}
+#endif
+			for (; i < n; i++)
 			{
-				fy = fys;
-				for (int32_t j = 0; j < h; j++, fy += fym)
-					Draw(x + i, y + j, sprite->GetPixel(fx + ox, fy + oy));
+				const olc::Pixel s = src[i], d = dst[i];
+				const uint32_t a = (s.a * b + 128) >> 8, c = 255 - a;
+				dst[i] = olc::Pixel(uint8_t(Div255(s.r * a + d.r * c)), uint8_t(Div255(s.g * a + d.g * c)), uint8_t(Div255(s.b * a + d.b * c)));
 			}
 		}
 	}
 
-	void PixelGameEngine::DrawPartialDecal(const olc::vf2d& pos, olc::Decal* decal, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::vf2d& scale, const olc::Pixel& tint)
+	// O------------------------------------------------------------------------------O
+	// | olc::PixelGameEngine IMPLEMENTATION                                          |
+	// O------------------------------------------------------------------------------O
+	PixelGameEngine::PixelGameEngine()
 	{
-		olc::vf2d vScreenSpacePos =
-		{
-			(pos.x * vInvScreenSize.x) * 2.0f - 1.0f,
-			((pos.y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f
-		};
-
-		olc::vf2d vScreenSpaceDim =
-		{
-			vScreenSpacePos.x + (2.0f * source_size.x * vInvScreenSize.x) * scale.x,
-			vScreenSpacePos.y - (2.0f * source_size.y * vInvScreenSize.y) * scale.y
-		};
-
-		DecalInstance di; di.decal = decal;	di.tint[0] = tint;
+		sAppName = "Undefined";
+		olc::PGEX::pge = this;
 
-		di.pos[0] = { vScreenSpacePos.x, vScreenSpacePos.y };
-		di.pos[1] = { vScreenSpacePos.x, vScreenSpaceDim.y };
-		di.pos[2] = { vScreenSpaceDim.x, vScreenSpaceDim.y };
-		di.pos[3] = { vScreenSpaceDim.x, vScreenSpacePos.y };
+		// Bring in relevant Platform & Rendering systems depending
+		// on compiler parameters
+		olc_ConfigureSystem();
+	}
 
-		olc::vf2d uvtl = source_pos * decal->vUVScale;
-		olc::vf2d uvbr = uvtl + (source_size * decal->vUVScale);
-		di.uv[0] = { uvtl.x, uvtl.y }; di.uv[1] = { uvtl.x, uvbr.y };
-		di.uv[2] = { uvbr.x, uvbr.y }; di.uv[3] = { uvbr.x, uvtl.y };
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+	PixelGameEngine::~PixelGameEngine()
+	{
+		olc_StopDrawWorkers();
 	}
 
-	void PixelGameEngine::DrawPartialDecal(const olc::vf2d& pos, const olc::vf2d& size, olc::Decal* decal, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::Pixel& tint)
+
+	olc::rcode PixelGameEngine::Construct(int32_t screen_w, int32_t screen_h, int32_t pixel_w, int32_t pixel_h, bool full_screen, bool vsync, bool cohesion, olc::GfxBackend backend)
 	{
-		olc::vf2d vScreenSpacePos =
-		{
-			(pos.x * vInvScreenSize.x) * 2.0f - 1.0f,
-			((pos.y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f
-		};
+		// Swap the renderer before any device exists, fails if that backend was not compiled in
+		if (backend != olc::GfxBackend::DEFAULT && olc_SelectRenderer(backend) == olc::FAIL)
+			return olc::FAIL;
 
-		olc::vf2d vScreenSpaceDim =
-		{
-			vScreenSpacePos.x + (2.0f * size.x * vInvScreenSize.x),
-			vScreenSpacePos.y - (2.0f * size.y * vInvScreenSize.y)
-		};
+		bPixelCohesion = cohesion;
+		vScreenSize = { screen_w, screen_h };
+		vInvScreenSize = { 1.0f / float(screen_w), 1.0f / float(screen_h) };
+		vPixelSize = { pixel_w, pixel_h };
+		vWindowSize = vScreenSize * vPixelSize;
+		bFullScreen = full_screen;
+		bEnableVSYNC = vsync;
+		vPixel = 2.0f / vScreenSize;
 
-		DecalInstance di; di.decal = decal;	di.tint[0] = tint;
+		if (vPixelSize.x <= 0 || vPixelSize.y <= 0 || vScreenSize.x <= 0 || vScreenSize.y <= 0)
+			return olc::FAIL;
 
-		di.pos[0] = { vScreenSpacePos.x, vScreenSpacePos.y };
-		di.pos[1] = { vScreenSpacePos.x, vScreenSpaceDim.y };
-		di.pos[2] = { vScreenSpaceDim.x, vScreenSpaceDim.y };
-		di.pos[3] = { vScreenSpaceDim.x, vScreenSpacePos.y };
 
-		olc::vf2d uvtl = source_pos * decal->vUVScale;
-		olc::vf2d uvbr = uvtl + (source_size * decal->vUVScale);
-		di.uv[0] = { uvtl.x, uvtl.y }; di.uv[1] = { uvtl.x, uvbr.y };
-		di.uv[2] = { uvbr.x, uvbr.y }; di.uv[3] = { uvbr.x, uvtl.y };
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		return olc::OK;
 	}
 
 
-	void PixelGameEngine::DrawDecal(const olc::vf2d& pos, olc::Decal* decal, const olc::vf2d& scale, const olc::Pixel& tint)
+	void PixelGameEngine::SetScreenSize(int w, int h)
 	{
-		olc::vf2d vScreenSpacePos =
-		{
-			(pos.x * vInvScreenSize.x) * 2.0f - 1.0f,
-			((pos.y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f
-		};
-
-		olc::vf2d vScreenSpaceDim =
-		{
-			vScreenSpacePos.x + (2.0f * (float(decal->sprite->width) * vInvScreenSize.x)) * scale.x,
-			vScreenSpacePos.y - (2.0f * (float(decal->sprite->height) * vInvScreenSize.y)) * scale.y
-		};
-
-		DecalInstance di;
-		di.decal = decal;
-		di.tint[0] = tint;
-		di.pos[0] = { vScreenSpacePos.x, vScreenSpacePos.y };
-		di.pos[1] = { vScreenSpacePos.x, vScreenSpaceDim.y };
-		di.pos[2] = { vScreenSpaceDim.x, vScreenSpaceDim.y };
-		di.pos[3] = { vScreenSpaceDim.x, vScreenSpacePos.y };
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
-	}
-
-	void PixelGameEngine::DrawRotatedDecal(const olc::vf2d& pos, olc::Decal* decal, const float fAngle, const olc::vf2d& center, const olc::vf2d& scale, const olc::Pixel& tint)
-	{
-		DecalInstance di;
-		di.decal = decal;
-		di.tint[0] = tint;
-		di.pos[0] = (olc::vf2d(0.0f, 0.0f) - center) * scale;
-		di.pos[1] = (olc::vf2d(0.0f, float(decal->sprite->height)) - center) * scale;
-		di.pos[2] = (olc::vf2d(float(decal->sprite->width), float(decal->sprite->height)) - center) * scale;
-		di.pos[3] = (olc::vf2d(float(decal->sprite->width), 0.0f) - center) * scale;
-		float c = cos(fAngle), s = sin(fAngle);
-		for (int i = 0; i < 4; i++)
+		vScreenSize = { w, h };
+		vInvScreenSize = { 1.0f / float(w), 1.0f / float(h) };
+		for (auto& layer : vLayers)
 		{
-			di.pos[i] = pos + olc::vf2d(di.pos[i].x * c - di.pos[i].y * s, di.pos[i].x * s + di.pos[i].y * c);
-			di.pos[i] = di.pos[i] * vInvScreenSize * 2.0f - olc::vf2d(1.0f, 1.0f);
-			di.pos[i].y *= -1.0f;
+			delete layer.pDrawTarget; // Erase existing layer sprites
+			layer.pDrawTarget = new Sprite(vScreenSize.x, vScreenSize.y);
+			layer.bUpdate = true;
 		}
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
-	}
+		SetDrawTarget(nullptr);
 
-	void PixelGameEngine::DrawExplicitDecal(olc::Decal* decal, const olc::vf2d* pos, const olc::vf2d* uv, const olc::Pixel* col)
-	{
-		DecalInstance di;
-		di.decal = decal;
-		for (int i = 0; i < 4; i++)
-		{
-			di.pos[i] = { (pos[i].x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos[i].y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
-			di.uv[i] = uv[i];
-			di.tint[i] = col[i];
-		}
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		renderer->ClearBuffer(olc::BLACK, true);
+		renderer->DisplayFrame();
+		renderer->ClearBuffer(olc::BLACK, true);
+		renderer->UpdateViewport(vViewPos, vViewSize);
 	}
 
-	void PixelGameEngine::FillRectDecal(const olc::vf2d& pos, const olc::vf2d& size, const olc::Pixel col)
+#if !defined(PGE_USE_CUSTOM_START)
+	olc::rcode PixelGameEngine::Start()
 	{
-		std::array<olc::vf2d, 4> points = { { {pos}, {pos.x, pos.y + size.y}, {pos + size}, {pos.x + size.x, pos.y} } };
-		std::array<olc::vf2d, 4> uvs = { {{0,0},{0,0},{0,0},{0,0}} };
-		std::array<olc::Pixel, 4> cols = { {col, col, col, col} };
-		DrawExplicitDecal(nullptr, points.data(), uvs.data(), cols.data());
-	}
+		if (platform->ApplicationStartUp() != olc::OK) return olc::FAIL;
 
-	void PixelGameEngine::GradientFillRectDecal(const olc::vf2d& pos, const olc::vf2d& size, const olc::Pixel colTL, const olc::Pixel colBL, const olc::Pixel colBR, const olc::Pixel colTR)
-	{
-		std::array<olc::vf2d, 4> points = { { {pos}, {pos.x, pos.y + size.y}, {pos + size}, {pos.x + size.x, pos.y} } };
-		std::array<olc::vf2d, 4> uvs = { {{0,0},{0,0},{0,0},{0,0}} };
-		std::array<olc::Pixel, 4> cols = { {colTL, colBL, colBR, colTR} };
-		DrawExplicitDecal(nullptr, points.data(), uvs.data(), cols.data());
-	}
+		// Construct the window
+		if (platform->CreateWindowPane({ 30,30 }, vWindowSize, bFullScreen) != olc::OK) return olc::FAIL;
+		olc_UpdateWindowSize(vWindowSize.x, vWindowSize.y);
 
+		// Start the thread
+		bAtomActive = true;
+		std::thread t = std::thread(&PixelGameEngine::EngineThread, this);
 
-	void PixelGameEngine::DrawPartialRotatedDecal(const olc::vf2d& pos, olc::Decal* decal, const float fAngle, const olc::vf2d& center, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::vf2d& scale, const olc::Pixel& tint)
-	{
-		DecalInstance di;
-		di.decal = decal;
-		di.tint[0] = tint;
-		di.pos[0] = (olc::vf2d(0.0f, 0.0f) - center) * scale;
-		di.pos[1] = (olc::vf2d(0.0f, source_size.y) - center) * scale;
-		di.pos[2] = (olc::vf2d(source_size.x, source_size.y) - center) * scale;
-		di.pos[3] = (olc::vf2d(source_size.x, 0.0f) - center) * scale;
-		float c = cos(fAngle), s = sin(fAngle);
-		for (int i = 0; i < 4; i++)
-		{
-			di.pos[i] = pos + olc::vf2d(di.pos[i].x * c - di.pos[i].y * s, di.pos[i].x * s + di.pos[i].y * c);
-			di.pos[i] = di.pos[i] * vInvScreenSize * 2.0f - olc::vf2d(1.0f, 1.0f);
-			di.pos[i].y *= -1.0f;
-		}
+		// Some implementations may form an event loop here
+		platform->StartSystemEventLoop();
 
-		olc::vf2d uvtl = source_pos * decal->vUVScale;
-		olc::vf2d uvbr = uvtl + (source_size * decal->vUVScale);
-		di.uv[0] = { uvtl.x, uvtl.y }; di.uv[1] = { uvtl.x, uvbr.y };
-		di.uv[2] = { uvbr.x, uvbr.y }; di.uv[3] = { uvbr.x, uvtl.y };
+		// Wait for thread to be exited
+		t.join();
 
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		if (platform->ApplicationCleanUp() != olc::OK) return olc::FAIL;
+
+		return olc::OK;
 	}
+#endif
 
-	void PixelGameEngine::DrawPartialWarpedDecal(olc::Decal* decal, const olc::vf2d* pos, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::Pixel& tint)
+	void PixelGameEngine::SetDrawTarget(Sprite* target)
 	{
-		DecalInstance di;
-		di.decal = decal;
-		di.tint[0] = tint;
-		olc::vf2d center;
-		float rd = ((pos[2].x - pos[0].x) * (pos[3].y - pos[1].y) - (pos[3].x - pos[1].x) * (pos[2].y - pos[0].y));
-		if (rd != 0)
+		if (target)
 		{
-			olc::vf2d uvtl = source_pos * decal->vUVScale;
-			olc::vf2d uvbr = uvtl + (source_size * decal->vUVScale);
-			di.uv[0] = { uvtl.x, uvtl.y }; di.uv[1] = { uvtl.x, uvbr.y };
-			di.uv[2] = { uvbr.x, uvbr.y }; di.uv[3] = { uvbr.x, uvtl.y };
-
-			rd = 1.0f / rd;
-			float rn = ((pos[3].x - pos[1].x) * (pos[0].y - pos[1].y) - (pos[3].y - pos[1].y) * (pos[0].x - pos[1].x)) * rd;
-			float sn = ((pos[2].x - pos[0].x) * (pos[0].y - pos[1].y) - (pos[2].y - pos[0].y) * (pos[0].x - pos[1].x)) * rd;
-			if (!(rn < 0.f || rn > 1.f || sn < 0.f || sn > 1.f)) center = pos[0] + rn * (pos[2] - pos[0]);
-			float d[4];	for (int i = 0; i < 4; i++)	d[i] = (pos[i] - center).mag();
-			for (int i = 0; i < 4; i++)
-			{
-				float q = d[i] == 0.0f ? 1.0f : (d[i] + d[(i + 2) & 3]) / d[(i + 2) & 3];
-				di.uv[i] *= q; di.w[i] *= q;
-				di.pos[i] = { (pos[i].x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos[i].y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
-			}
-			vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+			pDrawTarget = target;
+		}
+		else
+		{
+			nTargetLayer = 0;
+			pDrawTarget = vLayers[0].pDrawTarget;
 		}
 	}
 
-	void PixelGameEngine::DrawWarpedDecal(olc::Decal* decal, const olc::vf2d* pos, const olc::Pixel& tint)
+	void PixelGameEngine::SetDrawTarget(uint8_t layer)
 	{
-		// Thanks Nathan Reed, a brilliant article explaining whats going on here
-		// http://www.reedbeta.com/blog/quadrilateral-interpolation-part-1/
-		DecalInstance di;
-		di.decal = decal;
-		di.tint[0] = tint;
-		olc::vf2d center;
-		float rd = ((pos[2].x - pos[0].x) * (pos[3].y - pos[1].y) - (pos[3].x - pos[1].x) * (pos[2].y - pos[0].y));
-		if (rd != 0)
+		if (layer < vLayers.size())
 		{
-			rd = 1.0f / rd;
-			float rn = ((pos[3].x - pos[1].x) * (pos[0].y - pos[1].y) - (pos[3].y - pos[1].y) * (pos[0].x - pos[1].x)) * rd;
-			float sn = ((pos[2].x - pos[0].x) * (pos[0].y - pos[1].y) - (pos[2].y - pos[0].y) * (pos[0].x - pos[1].x)) * rd;
-			if (!(rn < 0.f || rn > 1.f || sn < 0.f || sn > 1.f)) center = pos[0] + rn * (pos[2] - pos[0]);
-			float d[4];	for (int i = 0; i < 4; i++)	d[i] = (pos[i] - center).mag();
-			for (int i = 0; i < 4; i++)
-			{
-				float q = d[i] == 0.0f ? 1.0f : (d[i] + d[(i + 2) & 3]) / d[(i + 2) & 3];
-				di.uv[i] *= q; di.w[i] *= q;
-				di.pos[i] = { (pos[i].x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos[i].y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
-			}
-			vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+			pDrawTarget = vLayers[layer].pDrawTarget;
+			if (!bDirtyTracking) vLayers[layer].bUpdate = true;
+			nTargetLayer = layer;
 		}
 	}
 
-	void PixelGameEngine::DrawWarpedDecal(olc::Decal* decal, const std::array<olc::vf2d, 4>& pos, const olc::Pixel& tint)
+	void PixelGameEngine::EnableLayer(uint8_t layer, bool b)
 	{
-		DrawWarpedDecal(decal, pos.data(), tint);
+		if (layer < vLayers.size()) vLayers[layer].bShow = b;
 	}
 
-	void PixelGameEngine::DrawWarpedDecal(olc::Decal* decal, const olc::vf2d(&pos)[4], const olc::Pixel& tint)
+	void PixelGameEngine::SetLayerOffset(uint8_t layer, const olc::vf2d& offset)
 	{
-		DrawWarpedDecal(decal, &pos[0], tint);
+		SetLayerOffset(layer, offset.x, offset.y);
 	}
 
-	void PixelGameEngine::DrawPartialWarpedDecal(olc::Decal* decal, const std::array<olc::vf2d, 4>& pos, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::Pixel& tint)
+	void PixelGameEngine::SetLayerOffset(uint8_t layer, float x, float y)
 	{
-		DrawPartialWarpedDecal(decal, pos.data(), source_pos, source_size, tint);
+		if (layer < vLayers.size()) vLayers[layer].vOffset = { x, y };
 	}
 
-	void PixelGameEngine::DrawPartialWarpedDecal(olc::Decal* decal, const olc::vf2d(&pos)[4], const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::Pixel& tint)
+	void PixelGameEngine::SetLayerScale(uint8_t layer, const olc::vf2d& scale)
 	{
-		DrawPartialWarpedDecal(decal, &pos[0], source_pos, source_size, tint);
+		SetLayerScale(layer, scale.x, scale.y);
 	}
 
-	void PixelGameEngine::DrawStringDecal(const olc::vf2d& pos, const std::string& sText, const Pixel col, const olc::vf2d& scale)
+	void PixelGameEngine::SetLayerScale(uint8_t layer, float x, float y)
 	{
-		olc::vf2d spos = { 0.0f, 0.0f };
-		for (auto c : sText)
-		{
-			if (c == '\n')
-			{
-				spos.x = 0; spos.y += 8.0f * scale.y;
-			}
-			else
-			{
-				int32_t ox = (c - 32) % 16;
-				int32_t oy = (c - 32) / 16;
-				DrawPartialDecal(pos + spos, fontDecal, { float(ox) * 8.0f, float(oy) * 8.0f }, { 8.0f, 8.0f }, scale, col);
-				spos.x += 8.0f * scale.x;
-			}
-		}
+		if (layer < vLayers.size()) vLayers[layer].vScale = { x, y };
 	}
 
-	olc::vi2d PixelGameEngine::GetTextSize(const std::string& s)
+	void PixelGameEngine::SetLayerTint(uint8_t layer, const olc::Pixel& tint)
 	{
-		olc::vi2d size = { 0,1 };
-		olc::vi2d pos = { 0,1 };
-		for (auto c : s)
-		{
-			if (c == '\n') { pos.y++;  pos.x = 0; }
-			else pos.x++;
-			size.x = std::max(size.x, pos.x);
-			size.y = std::max(size.y, pos.y);
-		}
-		return size * 8;
+		if (layer < vLayers.size()) vLayers[layer].tint = tint;
 	}
 
-	void PixelGameEngine::DrawString(const olc::vi2d& pos, const std::string& sText, Pixel col, uint32_t scale)
+	void PixelGameEngine::SetLayerCustomRenderFunction(uint8_t layer, std::function<void()> f)
 	{
-		DrawString(pos.x, pos.y, sText, col, scale);
+		if (layer < vLayers.size()) vLayers[layer].funcHook = f;
 	}
 
-	void PixelGameEngine::DrawString(int32_t x, int32_t y, const std::string& sText, Pixel col, uint32_t scale)
+	void PixelGameEngine::EnableDirtyTracking(bool b)
 	{
-		int32_t sx = 0;
-		int32_t sy = 0;
-		Pixel::Mode m = nPixelMode;
-		// Thanks @tucna, spotted bug with col.ALPHA :P
-		if (col.a != 255)		SetPixelMode(Pixel::ALPHA);
-		else					SetPixelMode(Pixel::MASK);
-		for (auto c : sText)
-		{
-			if (c == '\n')
-			{
-				sx = 0; sy += 8 * scale;
-			}
-			else
-			{
-				int32_t ox = (c - 32) % 16;
-				int32_t oy = (c - 32) / 16;
-
-				if (scale > 1)
-				{
-					for (uint32_t i = 0; i < 8; i++)
-						for (uint32_t j = 0; j < 8; j++)
-							if (fontSprite->GetPixel(i + ox * 8, j + oy * 8).r > 0)
-								for (uint32_t is = 0; is < scale; is++)
-									for (uint32_t js = 0; js < scale; js++)
-										Draw(x + sx + (i * scale) + is, y + sy + (j * scale) + js, col);
-				}
-				else
-				{
-					for (uint32_t i = 0; i < 8; i++)
-						for (uint32_t j = 0; j < 8; j++)
-							if (fontSprite->GetPixel(i + ox * 8, j + oy * 8).r > 0)
-								Draw(x + sx + i, y + sy + j, col);
-				}
-				sx += 8 * scale;
-			}
-		}
-		SetPixelMode(m);
+		bDirtyTracking = b;
+		// Anything drawn before now was not tracked
+		for (auto& layer : vLayers) layer.bUpdate = true;
 	}
 
-	void PixelGameEngine::SetPixelMode(Pixel::Mode m)
-	{ nPixelMode = m; }
-
-	Pixel::Mode PixelGameEngine::GetPixelMode()
-	{ return nPixelMode; }
-
-	void PixelGameEngine::SetPixelMode(std::function<olc::Pixel(const int x, const int y, const olc::Pixel&, const olc::Pixel&)> pixelMode)
+	void PixelGameEngine::olc_MarkDirty(int32_t x, int32_t y, int32_t w, int32_t h)
 	{
-		funcPixelMode = pixelMode;
-		nPixelMode = Pixel::Mode::CUSTOM;
+		if (!bDirtyTracking || w <= 0 || h <= 0 || vLayers.empty()) return;
+		// Drawing to a user sprite does not affect any layer
+		LayerDesc& layer = vLayers[nTargetLayer];
+		if (pDrawTarget != layer.pDrawTarget) return;
+		layer.vDirtyMin.x = std::min(layer.vDirtyMin.x, x);
+		layer.vDirtyMin.y = std::min(layer.vDirtyMin.y, y);
+		layer.vDirtyMax.x = std::max(layer.vDirtyMax.x, x + w - 1);
+		layer.vDirtyMax.y = std::max(layer.vDirtyMax.y, y + h - 1);
 	}
 
-	void PixelGameEngine::SetPixelBlend(float fBlend)
+	std::vector<LayerDesc>& PixelGameEngine::GetLayers()
+	{ return vLayers; }
+
+	uint32_t PixelGameEngine::CreateLayer()
 	{
-		fBlendFactor = fBlend;
-		if (fBlendFactor < 0.0f) fBlendFactor = 0.0f;
-		if (fBlendFactor > 1.0f) fBlendFactor = 1.0f;
+		LayerDesc ld;
+		ld.pDrawTarget = new olc::Sprite(vScreenSize.x, vScreenSize.y);
+		ld.nResID = renderer->CreateTexture(vScreenSize.x, vScreenSize.y);
+		renderer->UpdateTexture(ld.nResID, ld.pDrawTarget);
+		vLayers.push_back(ld);
+		return uint32_t(vLayers.size()) - 1;
 	}
 
-	// User must override these functions as required. I have not made
-	// them abstract because I do need a default behaviour to occur if
-	// they are not overwritten
-
-	bool PixelGameEngine::OnUserCreate()
-	{ return false; }
-
-	bool PixelGameEngine::OnUserUpdate(float fElapsedTime)
-	{ UNUSED(fElapsedTime);  return false; }
-
-	bool PixelGameEngine::OnUserDestroy()
-	{ return true; }
-	//////////////////////////////////////////////////////////////////
+	Sprite* PixelGameEngine::GetDrawTarget() const
+	{ return pDrawTarget; }
 
-	void PixelGameEngine::olc_UpdateViewport()
+	int32_t PixelGameEngine::GetDrawTargetWidth() const
 	{
-		int32_t ww = vScreenSize.x * vPixelSize.x;
-		int32_t wh = vScreenSize.y * vPixelSize.y;
-		float wasp = (float)ww / (float)wh;
-
-		if (bPixelCohesion)
-		{
-			vScreenPixelSize = (vWindowSize / vScreenSize);
-			vViewSize = (vWindowSize / vScreenSize) * vScreenSize;
-		}
+		if (pDrawTarget)
+			return pDrawTarget->width;
 		else
-		{
-			vViewSize.x = (int32_t)vWindowSize.x;
-			vViewSize.y = (int32_t)((float)vViewSize.x / wasp);
-
-			if (vViewSize.y > vWindowSize.y)
-			{
-				vViewSize.y = vWindowSize.y;
-				vViewSize.x = (int32_t)((float)vViewSize.y * wasp);
-			}
-		}
-
-		vViewPos = (vWindowSize - vViewSize) / 2;
+			return 0;
 	}
 
-	void PixelGameEngine::olc_UpdateWindowSize(int32_t x, int32_t y)
+	int32_t PixelGameEngine::GetDrawTargetHeight() const
 	{
-		vWindowSize = { x, y };
-		olc_UpdateViewport();
+		if (pDrawTarget)
+			return pDrawTarget->height;
+		else
+			return 0;
 	}
 
-	void PixelGameEngine::olc_UpdateMouseWheel(int32_t delta)
-	{
-		nMouseWheelDeltaCache += delta;
-	}
+	uint32_t PixelGameEngine::GetFPS() const
+	{ return nLastFPS; }
 
-	void PixelGameEngine::olc_UpdateMouse(int32_t x, int32_t y)
-	{
-		// Mouse coords come in screen space
-		// But leave in pixel space
-		bHasMouseFocus = true;
-		vMouseWindowPos = { x, y };
-		// Full Screen mode may have a weird viewport we must clamp to
-		x -= vViewPos.x;
-		y -= vViewPos.y;
-		vMousePosCache.x = (int32_t)(((float)x / (float)(vWindowSize.x - (vViewPos.x * 2)) * (float)vScreenSize.x));
-		vMousePosCache.y = (int32_t)(((float)y / (float)(vWindowSize.y - (vViewPos.y * 2)) * (float)vScreenSize.y));
-		if (vMousePosCache.x >= (int32_t)vScreenSize.x)	vMousePosCache.x = vScreenSize.x - 1;
-		if (vMousePosCache.y >= (int32_t)vScreenSize.y)	vMousePosCache.y = vScreenSize.y - 1;
-		if (vMousePosCache.x < 0) vMousePosCache.x = 0;
-		if (vMousePosCache.y < 0) vMousePosCache.y = 0;
-	}
+	bool PixelGameEngine::IsFocused() const
+	{ return bHasInputFocus; }
 
-	void PixelGameEngine::olc_UpdateMouseState(int32_t button, bool state)
-	{ pMouseNewState[button] = state; }
+	HWButton PixelGameEngine::GetKey(Key k) const
+	{ return pKeyboardState[k]; }
 
-	void PixelGameEngine::olc_UpdateKeyState(int32_t key, bool state)
-	{ pKeyNewState[key] = state; }
+	HWButton PixelGameEngine::GetMouse(uint32_t b) const
+	{ return pMouseState[b]; }
 
-	void PixelGameEngine::olc_UpdateMouseFocus(bool state)
-	{ bHasMouseFocus = state; }
+	int32_t PixelGameEngine::GetMouseX() const
+	{ return vMousePos.x; }
 
-	void PixelGameEngine::olc_UpdateKeyFocus(bool state)
-	{ bHasInputFocus = state; }
+	int32_t PixelGameEngine::GetMouseY() const
+	{ return vMousePos.y; }
 
-	void PixelGameEngine::olc_Terminate()
-	{ bAtomActive = false; }
+	const olc::vi2d& PixelGameEngine::GetMousePos() const
+	{ return vMousePos; }
 
-	void PixelGameEngine::EngineThread()
-	{
-		// Allow platform to do stuff here if needed, since its now in the
-		// context of this thread
-		if (platform->ThreadStartUp() == olc::FAIL)	return;
+	int32_t PixelGameEngine::GetMouseWheel() const
+	{ return nMouseWheelDelta; }
 
-		// Do engine context specific initialisation
-		olc_PrepareEngine();
+	int32_t PixelGameEngine::ScreenWidth() const
+	{ return vScreenSize.x; }
 
-		// Create user resources as part of this thread
-		if (!OnUserCreate()) bAtomActive = false;
+	int32_t PixelGameEngine::ScreenHeight() const
+	{ return vScreenSize.y; }
 
-		while (bAtomActive)
-		{
-			// Run as fast as possible
-			while (bAtomActive) { olc_CoreUpdate(); }
+	float PixelGameEngine::GetElapsedTime() const
+	{ return fLastElapsed; }
 
-			// Allow the user to free resources if they have overrided the destroy function
-			if (!OnUserDestroy())
-			{
-				// User denied destroy for some reason, so continue running
-				bAtomActive = true;
-			}
-		}
+	const olc::vi2d& PixelGameEngine::GetWindowSize() const
+	{ return vWindowSize; }
 
-		platform->ThreadCleanUp();
-	}
+	const olc::vi2d& PixelGameEngine::GetPixelSize() const
+	{ return vPixelSize; }
 
-	void PixelGameEngine::olc_PrepareEngine()
+	const olc::vi2d& PixelGameEngine::GetScreenPixelSize() const
+	{ return vScreenPixelSize; }
+
+	const olc::vi2d& PixelGameEngine::GetWindowMouse() const
+	{ return vMouseWindowPos; }
+
+	void PixelGameEngine::SetFrameRateLimit(float fFPS)
 	{
-		// Start OpenGL, the context is owned by the game thread
-		if (platform->CreateGraphics(bFullScreen, bEnableVSYNC, vViewPos, vViewSize) == olc::FAIL) return;
+		fFrameRateLimit = std::max(fFPS, 0.0f);
+		m_tpNextFrame = std::chrono::steady_clock::now();
+	}
 
-		// Construct default font sheet
-		olc_ConstructFontSheet();
+	void PixelGameEngine::SetIdle(bool b)
+	{ bIdle = b; }
 
-		// Create Primary Layer "0"
-		CreateLayer();
-		vLayers[0].bUpdate = true;
-		vLayers[0].bShow = true;
-		SetDrawTarget(nullptr);
+	void PixelGameEngine::WakeUp()
+	{ platform->WakeSystemEvent(); }
 
-		m_tp1 = std::chrono::system_clock::now();
-		m_tp2 = std::chrono::system_clock::now();
+#if defined(OLC_PLATFORM_HEADLESS)
+	olc::HeadlessConfig& PixelGameEngine::GetHeadlessConfig()
+	{ return cfgHeadless; }
+#endif
+
+	void PixelGameEngine::EnableProfiler(bool b)
+	{
+		// Kept once made, a scope on another thread may still be using it
+		if (b && pProfiler == nullptr) pProfiler = std::make_unique<olc::FrameProfiler>();
+		bProfile = b;
+		if (!b) bProfileOverlay = false;
+	}
+
+	void PixelGameEngine::EnableProfilerOverlay(bool b)
+	{
+		if (b) EnableProfiler(true);
+		bProfileOverlay = b;
 	}
 
+	olc::FrameProfiler* PixelGameEngine::GetProfiler()
+	{ return bProfile ? pProfiler.get() : nullptr; }
 
-	void PixelGameEngine::olc_CoreUpdate()
+	void PixelGameEngine::EnableTracing(bool b, const std::string& sFile)
 	{
-		// Handle Timing
-		m_tp2 = std::chrono::system_clock::now();
-		std::chrono::duration<float> elapsedTime = m_tp2 - m_tp1;
-		m_tp1 = m_tp2;
+		// As for the profiler, it is kept once made
+		if (b && pTrace == nullptr) pTrace = std::make_unique<olc::TraceLog>();
+		if (b) sTraceFile = sFile;
+		bTrace = b;
 
-		// Our time per frame coefficient
-		float fElapsedTime = elapsedTime.count();
-		fLastElapsed = fElapsedTime;
+		// Once running, this is called from the user callbacks, on the engine thread
+		if (b && bAtomActive) pTrace->SetThreadName("Engine");
+	}
 
-		// Some platforms will need to check for events
-		platform->HandleSystemEvent();
+	olc::rcode PixelGameEngine::SaveTrace()
+	{ return pTrace != nullptr ? pTrace->Save(sTraceFile) : olc::FAIL; }
 
-		// Compare hardware input states from previous frame
-		auto ScanHardware = [&](HWButton* pKeys, bool* pStateOld, bool* pStateNew, uint32_t nKeyCount)
+	olc::TraceLog* PixelGameEngine::GetTrace()
+	{ return bTrace ? pTrace.get() : nullptr; }
+
+	void PixelGameEngine::olc_DrawProfilerOverlay()
+	{
+		// Small screens get half size text, so a row still fits
+		const float fScale = ScreenWidth() >= 192 ? 1.0f : 0.5f;
+		const float fRow = 8.0f * fScale + 1.0f;
+		const float fWidth = float(ScreenWidth());
+		const float fBudget = 1.0f / 60.0f;
+		const uint32_t nSeries = pProfiler->SeriesCount();
+
+		auto Milliseconds = [](float f)
 		{
-			for (uint32_t i = 0; i < nKeyCount; i++)
-			{
-				pKeys[i].bPressed = false;
-				pKeys[i].bReleased = false;
-				if (pStateNew[i] != pStateOld[i])
-				{
-					if (pStateNew[i])
-					{
-						pKeys[i].bPressed = !pKeys[i].bHeld;
-						pKeys[i].bHeld = true;
-					}
-					else
-					{
-						pKeys[i].bReleased = true;
-						pKeys[i].bHeld = false;
-					}
-				}
-				pStateOld[i] = pStateNew[i];
-			}
+			std::string s = std::to_string(f * 1000.0f);
+			return s.substr(0, s.find('.') + 3);
 		};
 
-		ScanHardware(pKeyboardState, pKeyOldState, pKeyNewState, 256);
-		ScanHardware(pMouseState, pMouseOldState, pMouseNewState, nMouseButtons);
-
-		// Cache mouse coordinates so they remain consistent during frame
-		vMousePos = vMousePosCache;
-		nMouseWheelDelta = nMouseWheelDeltaCache;
-		nMouseWheelDeltaCache = 0;
-
-		//	renderer->ClearBuffer(olc::BLACK, true);
+		const uint8_t nLayer = nTargetLayer;
+		nTargetLayer = 0;
+		FillRectDecal({ 0.0f, 0.0f }, { fWidth, fRow * float(nSeries) + 1.0f }, olc::Pixel(0, 0, 0, 160));
+		for (uint32_t i = 0; i < nSeries; i++)
+		{
+			const float p50 = pProfiler->Percentile(i, 0.5f), p99 = pProfiler->Percentile(i, 0.99f);
+			const olc::vf2d vPos = { 0.0f, 1.0f + fRow * float(i) };
+			FillRectDecal(vPos, { fWidth * std::min(p99 / fBudget, 1.0f), fRow - 1.0f }, olc::Pixel(255, 64, 64, 128));
+			FillRectDecal(vPos, { fWidth * std::min(p50 / fBudget, 1.0f), fRow - 1.0f }, olc::Pixel(64, 160, 255, 160));
+
+			std::string sName = pProfiler->SeriesName(i).substr(0, 7);
+			sName.resize(8, ' ');
+			DrawStringDecal(vPos + olc::vf2d(1.0f, 0.0f), sName + Milliseconds(p50) + "/" + Milliseconds(p99), olc::WHITE, { fScale, fScale });
+		}
+		nTargetLayer = nLayer;
+	}
 
-			// Handle Frame Update
-		if (!OnUserUpdate(fElapsedTime))
-			bAtomActive = false;
 
-		// Display Frame
-		renderer->UpdateViewport(vViewPos, vViewSize);
-		renderer->ClearBuffer(olc::BLACK, true);
+	bool PixelGameEngine::Draw(const olc::vi2d& pos, Pixel p)
+	{
+		return Draw(pos.x, pos.y, p);
+	}
 
-		// Layer 0 must always exist
-		vLayers[0].bUpdate = true;
-		vLayers[0].bShow = true;
-		renderer->PrepareDrawing();
+	// This is it, the critical function that plots a pixel
+	bool PixelGameEngine::Draw(int32_t x, int32_t y, Pixel p)
+	{
+		if (!pDrawTarget) return false;
+		if (bDirtyTracking && !bDirtyBatch) olc_MarkDirty(x, y, 1, 1);
 
-		for (auto layer = vLayers.rbegin(); layer != vLayers.rend(); ++layer)
+		if (olc_Defer())
 		{
-			if (layer->bShow)
-			{
-				if (layer->funcHook == nullptr)
-				{
-					renderer->ApplyTexture(layer->nResID);
-					if (layer->bUpdate)
-					{
-						renderer->UpdateTexture(layer->nResID, layer->pDrawTarget);
-						layer->bUpdate = false;
-					}
+			olc_RecordDraw(DrawCommand::PIXEL, p, { x, y });
+			return x >= 0 && x < pDrawTarget->width && y >= 0 && y < pDrawTarget->height && (nPixelMode != Pixel::MASK || p.a == 255);
+		}
 
-					renderer->DrawLayerQuad(layer->vOffset, layer->vScale, layer->tint);
+		return olc_Plot(pDrawTarget, nPixelMode, fBlendFactor, x, y, p);
+	}
 
-					// Display Decals in order for this layer
-					for (auto& decal : layer->vecDecalInstance)
-						renderer->DrawDecalQuad(decal);
-					layer->vecDecalInstance.clear();
-				}
-				else
-				{
-					// Mwa ha ha.... Have Fun!!!
-					layer->funcHook();
-				}
-			}
+	bool PixelGameEngine::olc_Plot(Sprite* pTarget, Pixel::Mode nMode, float fBlend, int32_t x, int32_t y, Pixel p)
+	{
+		if (nMode == Pixel::NORMAL)
+		{
+			return pTarget->SetPixel(x, y, p);
 		}
 
-		// Present Graphics to screen
-		renderer->DisplayFrame();
+		if (nMode == Pixel::MASK)
+		{
+			if (p.a == 255)
+				return pTarget->SetPixel(x, y, p);
+		}
 
-		// Update Title Bar
-		fFrameTimer += fElapsedTime;
-		nFrameCount++;
-		if (fFrameTimer >= 1.0f)
+		if (nMode == Pixel::ALPHA)
 		{
-			nLastFPS = nFrameCount;
-			fFrameTimer -= 1.0f;
-			std::string sTitle = "OneLoneCoder.com - Pixel Game Engine - " + sAppName + " - FPS: " + std::to_string(nFrameCount);
-			platform->SetWindowTitle(sTitle);
-			nFrameCount = 0;
+			Pixel d = pTarget->GetPixel(x, y);
+			float a = (float)(p.a / 255.0f) * fBlend;
+			float c = 1.0f - a;
+			float r = a * (float)p.r + c * (float)d.r;
+			float g = a * (float)p.g + c * (float)d.g;
+			float b = a * (float)p.b + c * (float)d.b;
+			return pTarget->SetPixel(x, y, Pixel((uint8_t)r, (uint8_t)g, (uint8_t)b/*, (uint8_t)(p.a * fBlendFactor)*/));
 		}
-	}
 
-	void PixelGameEngine::olc_ConstructFontSheet()
+		if (nMode == Pixel::CUSTOM)
+		{
+			return pTarget->SetPixel(x, y, funcPixelMode(x, y, p, pTarget->GetPixel(x, y)));
+		}
+
+		return false;
+	}
+
+
+	void PixelGameEngine::DrawLine(const olc::vi2d& pos1, const olc::vi2d& pos2, Pixel p, uint32_t pattern)
 	{
-		std::string data;
-		data += "?Q`0001oOch0o01o@F40o0<AGD4090LAGD<090@A7ch0?00O7Q`0600>00000000";
-		data += "O000000nOT0063Qo4d8>?7a14Gno94AA4gno94AaOT0>o3`oO400o7QN00000400";
-		data += "Of80001oOg<7O7moBGT7O7lABET024@aBEd714AiOdl717a_=TH013Q>00000000";
-		data += "720D000V?V5oB3Q_HdUoE7a9@DdDE4A9@DmoE4A;Hg]oM4Aj8S4D84@`00000000";
-		data += "OaPT1000Oa`^13P1@AI[?g`1@A=[OdAoHgljA4Ao?WlBA7l1710007l100000000";
-		data += "ObM6000oOfMV?3QoBDD`O7a0BDDH@5A0BDD<@5A0BGeVO5ao@CQR?5Po00000000";
-		data += "Oc``000?Ogij70PO2D]??0Ph2DUM@7i`2DTg@7lh2GUj?0TO0C1870T?00000000";
-		data += "70<4001o?P<7?1QoHg43O;`h@GT0@:@LB@d0>:@hN@L0@?aoN@<0O7ao0000?000";
-		data += "OcH0001SOglLA7mg24TnK7ln24US>0PL24U140PnOgl0>7QgOcH0K71S0000A000";
-		data += "00H00000@Dm1S007@DUSg00?OdTnH7YhOfTL<7Yh@Cl0700?@Ah0300700000000";
-		data += "<008001QL00ZA41a@6HnI<1i@FHLM81M@@0LG81?O`0nC?Y7?`0ZA7Y300080000";
-		data += "O`082000Oh0827mo6>Hn?Wmo?6HnMb11MP08@C11H`08@FP0@@0004@000000000";
-		data += "00P00001Oab00003OcKP0006@6=PMgl<@440MglH@000000`@000001P00000000";
-		data += "Ob@8@@00Ob@8@Ga13R@8Mga172@8?PAo3R@827QoOb@820@0O`0007`0000007P0";
-		data += "O`000P08Od400g`<3V=P0G`673IP0`@3>1`00P@6O`P00g`<O`000GP800000000";
-		data += "?P9PL020O`<`N3R0@E4HC7b0@ET<ATB0@@l6C4B0O`H3N7b0?P01L3R000000020";
+		DrawLine(pos1.x, pos1.y, pos2.x, pos2.y, p, pattern);
+	}
 
-		fontSprite = new olc::Sprite(128, 48);
-		int px = 0, py = 0;
-		for (size_t b = 0; b < 1024; b += 4)
+	void PixelGameEngine::DrawLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, Pixel p, uint32_t pattern)
+	{
+		int x, y, dx, dy, dx1, dy1, px, py, xe, ye, i;
+		dx = x2 - x1; dy = y2 - y1;
+
+		auto rol = [&](void) { pattern = (pattern << 1) | (pattern >> 31); return pattern & 1; };
+
+		// straight lines idea by gurkanctn
+		if (dx == 0) // Line is vertical
 		{
-			uint32_t sym1 = (uint32_t)data[b + 0] - 48;
-			uint32_t sym2 = (uint32_t)data[b + 1] - 48;
-			uint32_t sym3 = (uint32_t)data[b + 2] - 48;
-			uint32_t sym4 = (uint32_t)data[b + 3] - 48;
-			uint32_t r = sym1 << 18 | sym2 << 12 | sym3 << 6 | sym4;
+			if (y2 < y1) std::swap(y1, y2);
+			for (y = y1; y <= y2; y++) if (rol()) Draw(x1, y, p);
+			return;
+		}
 
-			for (int i = 0; i < 24; i++)
+		if (dy == 0) // Line is horizontal
+		{
+			if (x2 < x1) std::swap(x1, x2);
+			for (x = x1; x <= x2; x++) if (rol()) Draw(x, y1, p);
+			return;
+		}
+
+		// Line is Funk-aye
+		dx1 = abs(dx); dy1 = abs(dy);
+		px = 2 * dy1 - dx1;	py = 2 * dx1 - dy1;
+		if (dy1 <= dx1)
+		{
+			if (dx >= 0)
 			{
-				int k = r & (1 << i) ? 255 : 0;
-				fontSprite->SetPixel(px, py, olc::Pixel(k, k, k, k));
-				if (++py == 48) { px++; py = 0; }
+				x = x1; y = y1; xe = x2;
+			}
+			else
+			{
+				x = x2; y = y2; xe = x1;
+			}
+
+			if (rol()) Draw(x, y, p);
+
+			for (i = 0; x < xe; i++)
+			{
+				x = x + 1;
+				if (px < 0)
+					px = px + 2 * dy1;
+				else
+				{
+					if ((dx < 0 && dy < 0) || (dx > 0 && dy > 0)) y = y + 1; else y = y - 1;
+					px = px + 2 * (dy1 - dx1);
+				}
+				if (rol()) Draw(x, y, p);
+			}
+		}
+		else
+		{
+			if (dy >= 0)
+			{
+				x = x1; y = y1; ye = y2;
+			}
+			else
+			{
+				x = x2; y = y2; ye = y1;
+			}
+
+			if (rol()) Draw(x, y, p);
+
+			for (i = 0; y < ye; i++)
+			{
+				y = y + 1;
+				if (py <= 0)
+					py = py + 2 * dx1;
+				else
+				{
+					if ((dx < 0 && dy < 0) || (dx > 0 && dy > 0)) x = x + 1; else x = x - 1;
+					py = py + 2 * (dx1 - dy1);
+				}
+				if (rol()) Draw(x, y, p);
 			}
 		}
+	}
 
-		fontDecal = new olc::Decal(fontSprite);
+	void PixelGameEngine::DrawCircle(const olc::vi2d& pos, int32_t radius, Pixel p, uint8_t mask)
+	{
+		DrawCircle(pos.x, pos.y, radius, p, mask);
 	}
 
-	// Need a couple of statics as these are singleton instances
-	// read from multiple locations
-	std::atomic<bool> PixelGameEngine::bAtomActive{ false };
-	olc::PixelGameEngine* olc::PGEX::pge = nullptr;
-	olc::PixelGameEngine* olc::Platform::ptrPGE = nullptr;
-	olc::PixelGameEngine* olc::Renderer::ptrPGE = nullptr;
-	std::unique_ptr<ImageLoader> olc::Sprite::loader = nullptr;
-};
+	void PixelGameEngine::DrawCircle(int32_t x, int32_t y, int32_t radius, Pixel p, uint8_t mask)
+	{ // Thanks to IanM-Matrix1 #PR121
+		if (radius < 0 || x < -radius || y < -radius || x - GetDrawTargetWidth() > radius || y - GetDrawTargetHeight() > radius)
+			return;
+
+		if (radius > 0)
+		{
+			int x0 = 0;
+			int y0 = radius;
+			int d = 3 - 2 * radius;
 
+			while (y0 >= x0) // only formulate 1/8 of circle
+			{
+				// Draw even octants
+				if (mask & 0x01) Draw(x + x0, y - y0, p);// Q6 - upper right right
+				if (mask & 0x04) Draw(x + y0, y + x0, p);// Q4 - lower lower right
+				if (mask & 0x10) Draw(x - x0, y + y0, p);// Q2 - lower left left
+				if (mask & 0x40) Draw(x - y0, y - x0, p);// Q0 - upper upper left
+				if (x0 != 0 && x0 != y0)
+				{
+					if (mask & 0x02) Draw(x + y0, y - x0, p);// Q7 - upper upper right
+					if (mask & 0x08) Draw(x + x0, y + y0, p);// Q5 - lower right right
+					if (mask & 0x20) Draw(x - y0, y + x0, p);// Q3 - lower lower left
+					if (mask & 0x80) Draw(x - x0, y - y0, p);// Q1 - upper left left
+				}
 
+				if (d < 0)
+					d += 4 * x0++ + 6;
+				else
+					d += 4 * (x0++ - y0--) + 10;
+			}
+		}
+		else
+			Draw(x, y, p);
+	}
 
-// O------------------------------------------------------------------------------O
-// | olcPixelGameEngine PLATFORM SPECIFIC IMPLEMENTATIONS                         |
+	void PixelGameEngine::FillCircle(const olc::vi2d& pos, int32_t radius, Pixel p)
+	{
+		FillCircle(pos.x, pos.y, radius, p);
+	}
+
+	void PixelGameEngine::FillCircle(int32_t x, int32_t y, int32_t radius, Pixel p)
+	{ // Thanks to IanM-Matrix1 #PR121
+		if (radius < 0 || x < -radius || y < -radius || x - GetDrawTargetWidth() > radius || y - GetDrawTargetHeight() > radius)
+			return;
+
+		if (radius > 0)
+		{
+			int x0 = 0;
+			int y0 = radius;
+			int d = 3 - 2 * radius;
+
+			auto drawline = [&](int sx, int ex, int y)
+			{
+				for (int x = sx; x <= ex; x++)
+					Draw(x, y, p);
+			};
+
+			while (y0 >= x0)
+			{
+				drawline(x - y0, x + y0, y - x0);
+				if (x0 > 0)	drawline(x - y0, x + y0, y + x0);
+
+				if (d < 0)
+					d += 4 * x0++ + 6;
+				else
+				{
+					if (x0 != y0)
+					{
+						drawline(x - x0, x + x0, y - y0);
+						drawline(x - x0, x + x0, y + y0);
+					}
+					d += 4 * (x0++ - y0--) + 10;
+				}
+			}
+		}
+		else
+			Draw(x, y, p);
+	}
+
+	void PixelGameEngine::DrawRect(const olc::vi2d& pos, const olc::vi2d& size, Pixel p)
+	{
+		DrawRect(pos.x, pos.y, size.x, size.y, p);
+	}
+
+	void PixelGameEngine::DrawRect(int32_t x, int32_t y, int32_t w, int32_t h, Pixel p)
+	{
+		DrawLine(x, y, x + w, y, p);
+		DrawLine(x + w, y, x + w, y + h, p);
+		DrawLine(x + w, y + h, x, y + h, p);
+		DrawLine(x, y + h, x, y, p);
+	}
+
+	void PixelGameEngine::Clear(Pixel p)
+	{
+		if (!pDrawTarget) return;
+		olc_MarkDirty(0, 0, GetDrawTargetWidth(), GetDrawTargetHeight());
+		if (bDeferred)
+			olc_RecordDraw(DrawCommand::CLEAR, p, {});
+		else
+			span::Fill(pDrawTarget->GetData(), GetDrawTargetWidth() * GetDrawTargetHeight(), p);
+	}
+
+	void PixelGameEngine::ClearBuffer(Pixel p, bool bDepth)
+	{
+		renderer->ClearBuffer(p, bDepth);
+	}
+
+	void PixelGameEngine::FillRect(const olc::vi2d& pos, const olc::vi2d& size, Pixel p)
+	{
+		FillRect(pos.x, pos.y, size.x, size.y, p);
+	}
+
+	void PixelGameEngine::FillRect(int32_t x, int32_t y, int32_t w, int32_t h, Pixel p)
+	{
+		int32_t x2 = x + w;
+		int32_t y2 = y + h;
+
+		if (x < 0) x = 0;
+		if (x >= (int32_t)GetDrawTargetWidth()) x = (int32_t)GetDrawTargetWidth();
+		if (y < 0) y = 0;
+		if (y >= (int32_t)GetDrawTargetHeight()) y = (int32_t)GetDrawTargetHeight();
+
+		if (x2 < 0) x2 = 0;
+		if (x2 >= (int32_t)GetDrawTargetWidth()) x2 = (int32_t)GetDrawTargetWidth();
+		if (y2 < 0) y2 = 0;
+		if (y2 >= (int32_t)GetDrawTargetHeight()) y2 = (int32_t)GetDrawTargetHeight();
+
+		if (!pDrawTarget || x >= x2 || y >= y2) return;
+
+		// Mark the whole area once, rather than every pixel
+		olc_MarkDirty(x, y, x2 - x, y2 - y);
+
+		if (olc_Defer())
+			olc_RecordDraw(DrawCommand::RECT, p, { x, y, x2 - x, y2 - y });
+		else
+			olc_RasterRect(olc_RasterState(), x, y, x2 - x, y2 - y, p);
+	}
+
+	void PixelGameEngine::olc_RasterSpan(const RasterState& rs, int32_t x1, int32_t x2, int32_t y, Pixel p)
+	{
+		if (y < rs.vClipMin.y || y >= rs.vClipMax.y) return;
+		x1 = std::max(x1, rs.vClipMin.x); x2 = std::min(x2, rs.vClipMax.x);
+		if (x1 >= x2) return;
+
+		Pixel* pRow = rs.pTarget->GetData() + y * rs.pTarget->width + x1;
+		switch (rs.nMode)
+		{
+		case Pixel::NORMAL: span::Fill(pRow, x2 - x1, p); break;
+		case Pixel::MASK: if (p.a == 255) span::Fill(pRow, x2 - x1, p); break;
+		case Pixel::ALPHA: span::FillBlend(pRow, x2 - x1, p, rs.fBlend); break;
+		default:
+			for (int32_t i = x1; i < x2; i++) olc_Plot(rs.pTarget, rs.nMode, rs.fBlend, i, y, p);
+		}
+	}
+
+	void PixelGameEngine::olc_RasterRect(const RasterState& rs, int32_t x, int32_t y, int32_t w, int32_t h, Pixel p)
+	{
+		const int32_t y2 = std::min(y + h, rs.vClipMax.y);
+		for (int32_t j = std::max(y, rs.vClipMin.y); j < y2; j++)
+			olc_RasterSpan(rs, x, x + w, j, p);
+	}
+
+	void PixelGameEngine::DrawTriangle(const olc::vi2d& pos1, const olc::vi2d& pos2, const olc::vi2d& pos3, Pixel p)
+	{
+		DrawTriangle(pos1.x, pos1.y, pos2.x, pos2.y, pos3.x, pos3.y, p);
+	}
+
+	void PixelGameEngine::DrawTriangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p)
+	{
+		DrawLine(x1, y1, x2, y2, p);
+		DrawLine(x2, y2, x3, y3, p);
+		DrawLine(x3, y3, x1, y1, p);
+	}
+
+	void PixelGameEngine::FillTriangle(const olc::vi2d& pos1, const olc::vi2d& pos2, const olc::vi2d& pos3, Pixel p)
+	{
+		FillTriangle(pos1.x, pos1.y, pos2.x, pos2.y, pos3.x, pos3.y, p);
+	}
+
+	// https://www.avrfreaks.net/sites/default/files/triangles.c
+	void PixelGameEngine::FillTriangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p)
+	{
+		if (!pDrawTarget) return;
+		const int32_t minx = std::min({ x1, x2, x3 }), maxx = std::max({ x1, x2, x3 });
+		const int32_t miny = std::min({ y1, y2, y3 }), maxy = std::max({ y1, y2, y3 });
+		olc_MarkDirty(minx, miny, maxx - minx + 1, maxy - miny + 1);
+
+		if (olc_Defer())
+			olc_RecordDraw(DrawCommand::TRIANGLE, p, { x1, y1, x2, y2, x3, y3 });
+		else
+			olc_RasterTriangle(olc_RasterState(), x1, y1, x2, y2, x3, y3, p);
+	}
+
+	void PixelGameEngine::olc_RasterTriangle(const RasterState& rs, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p)
+	{
+		auto drawline = [&](int sx, int ex, int ny) { olc_RasterSpan(rs, sx, ex + 1, ny, p); };
+
+		int t1x, t2x, y, minx, maxx, t1xp, t2xp;
+		bool changed1 = false;
+		bool changed2 = false;
+		int signx1, signx2, dx1, dy1, dx2, dy2;
+		int e1, e2;
+		// Sort vertices
+		if (y1 > y2) { std::swap(y1, y2); std::swap(x1, x2); }
+		if (y1 > y3) { std::swap(y1, y3); std::swap(x1, x3); }
+		if (y2 > y3) { std::swap(y2, y3); std::swap(x2, x3); }
+
+		t1x = t2x = x1; y = y1;   // Starting points
+		dx1 = (int)(x2 - x1);
+		if (dx1 < 0) { dx1 = -dx1; signx1 = -1; }
+		else signx1 = 1;
+		dy1 = (int)(y2 - y1);
+
+		dx2 = (int)(x3 - x1);
+		if (dx2 < 0) { dx2 = -dx2; signx2 = -1; }
+		else signx2 = 1;
+		dy2 = (int)(y3 - y1);
+
+		if (dy1 > dx1) { std::swap(dx1, dy1); changed1 = true; }
+		if (dy2 > dx2) { std::swap(dy2, dx2); changed2 = true; }
+
+		e2 = (int)(dx2 >> 1);
+		// Flat top, just process the second half
+		if (y1 == y2) goto next;
+		e1 = (int)(dx1 >> 1);
+
+		for (int i = 0; i < dx1;) {
+			t1xp = 0; t2xp = 0;
+			if (t1x < t2x) { minx = t1x; maxx = t2x; }
+			else { minx = t2x; maxx = t1x; }
+			// process first line until y value is about to change
+			while (i < dx1) {
+				i++;
+				e1 += dy1;
+				while (e1 >= dx1) {
+					e1 -= dx1;
+					if (changed1) t1xp = signx1;//t1x += signx1;
+					else          goto next1;
+				}
+				if (changed1) break;
+				else t1x += signx1;
+			}
+			// Move line
+		next1:
+			// process second line until y value is about to change
+			while (1) {
+				e2 += dy2;
+				while (e2 >= dx2) {
+					e2 -= dx2;
+					if (changed2) t2xp = signx2;//t2x += signx2;
+					else          goto next2;
+				}
+				if (changed2)     break;
+				else              t2x += signx2;
+			}
+		next2:
+			if (minx > t1x) minx = t1x;
+			if (minx > t2x) minx = t2x;
+			if (maxx < t1x) maxx = t1x;
+			if (maxx < t2x) maxx = t2x;
+			drawline(minx, maxx, y);    // Draw line from min to max points found on the y
+										// Now increase y
+			if (!changed1) t1x += signx1;
+			t1x += t1xp;
+			if (!changed2) t2x += signx2;
+			t2x += t2xp;
+			y += 1;
+			if (y == y2) break;
+
+		}
+	next:
+		// Second half
+		dx1 = (int)(x3 - x2); if (dx1 < 0) { dx1 = -dx1; signx1 = -1; }
+		else signx1 = 1;
+		dy1 = (int)(y3 - y2);
+		t1x = x2;
+
+		if (dy1 > dx1) {   // swap values
+			std::swap(dy1, dx1);
+			changed1 = true;
+		}
+		else changed1 = false;
+
+		e1 = (int)(dx1 >> 1);
+
+		for (int i = 0; i <= dx1; i++) {
+			t1xp = 0; t2xp = 0;
+			if (t1x < t2x) { minx = t1x; maxx = t2x; }
+			else { minx = t2x; maxx = t1x; }
+			// process first line until y value is about to change
+			while (i < dx1) {
+				e1 += dy1;
+				while (e1 >= dx1) {
+					e1 -= dx1;
+					if (changed1) { t1xp = signx1; break; }//t1x += signx1;
+					else          goto next3;
+				}
+				if (changed1) break;
+				else   	   	  t1x += signx1;
+				if (i < dx1) i++;
+			}
+		next3:
+			// process second line until y value is about to change
+			while (t2x != x3) {
+				e2 += dy2;
+				while (e2 >= dx2) {
+					e2 -= dx2;
+					if (changed2) t2xp = signx2;
+					else          goto next4;
+				}
+				if (changed2)     break;
+				else              t2x += signx2;
+			}
+		next4:
+
+			if (minx > t1x) minx = t1x;
+			if (minx > t2x) minx = t2x;
+			if (maxx < t1x) maxx = t1x;
+			if (maxx < t2x) maxx = t2x;
+			drawline(minx, maxx, y);
+			if (!changed1) t1x += signx1;
+			t1x += t1xp;
+			if (!changed2) t2x += signx2;
+			t2x += t2xp;
+			y += 1;
+			if (y > y3) return;
+		}
+	}
+
+	void PixelGameEngine::DrawSprite(const olc::vi2d& pos, Sprite* sprite, uint32_t scale, uint8_t flip)
+	{
+		DrawSprite(pos.x, pos.y, sprite, scale, flip);
+	}
+
+	void PixelGameEngine::DrawSprite(int32_t x, int32_t y, Sprite* sprite, uint32_t scale, uint8_t flip)
+	{
+		if (sprite == nullptr)
+			return;
+
+		DrawPartialSprite(x, y, sprite, 0, 0, sprite->width, sprite->height, scale, flip);
+	}
+
+	void PixelGameEngine::DrawPartialSprite(const olc::vi2d& pos, Sprite* sprite, const olc::vi2d& sourcepos, const olc::vi2d& size, uint32_t scale, uint8_t flip)
+	{
+		DrawPartialSprite(pos.x, pos.y, sprite, sourcepos.x, sourcepos.y, size.x, size.y, scale, flip);
+	}
+
+	void PixelGameEngine::DrawPartialSprite(int32_t x, int32_t y, Sprite* sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, uint32_t scale, uint8_t flip)
+	{
+		if (sprite == nullptr || pDrawTarget == nullptr || w <= 0 || h <= 0)
+			return;
+
+		const int32_t s = scale > 1 ? int32_t(scale) : 1;
+		olc_MarkDirty(x, y, w * s, h * s);
+
+		if (olc_Defer(sprite))
+			olc_RecordDraw(DrawCommand::SPRITE, olc::BLANK, { x, y, ox, oy, w, h, s }, sprite, flip);
+		else
+			olc_RasterSprite(olc_RasterState(), x, y, sprite, ox, oy, w, h, s, flip);
+	}
+
+	void PixelGameEngine::olc_RasterSprite(const RasterState& rs, int32_t x, int32_t y, Sprite* sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, int32_t s, uint8_t flip)
+	{
+		// Clip the scaled rectangle once
+		const int32_t cx1 = std::min(x + w * s, rs.vClipMax.x), cx0 = std::max(x, rs.vClipMin.x);
+		const int32_t cy1 = std::min(y + h * s, rs.vClipMax.y), cy0 = std::max(y, rs.vClipMin.y);
+		if (cx0 >= cx1 || cy0 >= cy1) return;
+		const int32_t n = cx1 - cx0;
+
+		// Unscaled and unflipped rows inside the sprite are blitted straight from it,
+		// anything else is first expanded into a row buffer. Sources reaching outside
+		// the sprite are read via GetPixel(), to keep the sample mode's behaviour
+		const bool bFlipX = flip & olc::Sprite::Flip::HORIZ;
+		const bool bFlipY = flip & olc::Sprite::Flip::VERT;
+		const bool bInside = ox >= 0 && oy >= 0 && ox + w <= sprite->width && oy + h <= sprite->height;
+		const bool bDirect = bInside && s == 1 && !bFlipX;
+		std::vector<olc::Pixel>& vecRow = *rs.pRow;
+		if (!bDirect && int32_t(vecRow.size()) < n) vecRow.resize(n);
+
+		const olc::Pixel* pSrc = nullptr;
+		int32_t nSrcRow = -1;
+		for (int32_t dy = cy0; dy < cy1; dy++)
+		{
+			// When upscaling, each source row is expanded once and reused for
+			// every destination row it covers
+			const int32_t j = (dy - y) / s;
+			if (j != nSrcRow)
+			{
+				nSrcRow = j;
+				const int32_t sy = oy + (bFlipY ? h - 1 - j : j);
+				const int32_t i = (cx0 - x) / s;
+				if (bDirect)
+					pSrc = sprite->GetData() + sy * sprite->width + ox + i;
+				else
+				{
+					// Flipping just walks the source row backwards
+					const int32_t step = bFlipX ? -1 : 1;
+					int32_t sx = ox + (bFlipX ? w - 1 - i : i);
+					int32_t k = (cx0 - x) % s;
+					const olc::Pixel* pRow = sprite->GetData() + sy * sprite->width;
+					for (int32_t c = 0; c < n; c++)
+					{
+						vecRow[c] = bInside ? pRow[sx] : sprite->GetPixel(sx, sy);
+						if (++k == s) { k = 0; sx += step; }
+					}
+					pSrc = vecRow.data();
+				}
+			}
+
+			Pixel* pDst = rs.pTarget->GetData() + dy * rs.pTarget->width + cx0;
+			switch (rs.nMode)
+			{
+			case Pixel::NORMAL: span::Copy(pDst, pSrc, n); break;
+			case Pixel::MASK: span::Mask(pDst, pSrc, n); break;
+			case Pixel::ALPHA: span::Blend(pDst, pSrc, n, rs.fBlend); break;
+			default:
+				for (int32_t c = 0; c < n; c++) olc_Plot(rs.pTarget, rs.nMode, rs.fBlend, cx0 + c, dy, pSrc[c]);
+			}
+		}
+	}
+
+	void PixelGameEngine::DrawPartialDecal(const olc::vf2d& pos, olc::Decal* decal, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::vf2d& scale, const olc::Pixel& tint)
+	{
+		olc::vf2d vScreenSpacePos =
+		{
+			(pos.x * vInvScreenSize.x) * 2.0f - 1.0f,
+			((pos.y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f
+		};
+
+		olc::vf2d vScreenSpaceDim =
+		{
+			vScreenSpacePos.x + (2.0f * source_size.x * vInvScreenSize.x) * scale.x,
+			vScreenSpacePos.y - (2.0f * source_size.y * vInvScreenSize.y) * scale.y
+		};
+
+		DecalInstance di; di.decal = decal;	di.tint[0] = tint;
+
+		di.pos[0] = { vScreenSpacePos.x, vScreenSpacePos.y };
+		di.pos[1] = { vScreenSpacePos.x, vScreenSpaceDim.y };
+		di.pos[2] = { vScreenSpaceDim.x, vScreenSpaceDim.y };
+		di.pos[3] = { vScreenSpaceDim.x, vScreenSpacePos.y };
+
+		olc::vf2d uvtl = source_pos * decal->vUVScale;
+		olc::vf2d uvbr = uvtl + (source_size * decal->vUVScale);
+		di.uv[0] = { uvtl.x, uvtl.y }; di.uv[1] = { uvtl.x, uvbr.y };
+		di.uv[2] = { uvbr.x, uvbr.y }; di.uv[3] = { uvbr.x, uvtl.y };
+		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+	}
+
+	void PixelGameEngine::DrawPartialDecal(const olc::vf2d& pos, const olc::vf2d& size, olc::Decal* decal, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::Pixel& tint)
+	{
+		olc::vf2d vScreenSpacePos =
+		{
+			(pos.x * vInvScreenSize.x) * 2.0f - 1.0f,
+			((pos.y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f
+		};
+
+		olc::vf2d vScreenSpaceDim =
+		{
+			vScreenSpacePos.x + (2.0f * size.x * vInvScreenSize.x),
+			vScreenSpacePos.y - (2.0f * size.y * vInvScreenSize.y)
+		};
+
+		DecalInstance di; di.decal = decal;	di.tint[0] = tint;
+
+		di.pos[0] = { vScreenSpacePos.x, vScreenSpacePos.y };
+		di.pos[1] = { vScreenSpacePos.x, vScreenSpaceDim.y };
+		di.pos[2] = { vScreenSpaceDim.x, vScreenSpaceDim.y };
+		di.pos[3] = { vScreenSpaceDim.x, vScreenSpacePos.y };
+
+		olc::vf2d uvtl = source_pos * decal->vUVScale;
+		olc::vf2d uvbr = uvtl + (source_size * decal->vUVScale);
+		di.uv[0] = { uvtl.x, uvtl.y }; di.uv[1] = { uvtl.x, uvbr.y };
+		di.uv[2] = { uvbr.x, uvbr.y }; di.uv[3] = { uvbr.x, uvtl.y };
+		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+	}
+
+
+	void PixelGameEngine::DrawDecal(const olc::vf2d& pos, olc::Decal* decal, const olc::vf2d& scale, const olc::Pixel& tint)
+	{
+		olc::vf2d vScreenSpacePos =
+		{
+			(pos.x * vInvScreenSize.x) * 2.0f - 1.0f,
+			((pos.y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f
+		};
+
+		olc::vf2d vScreenSpaceDim =
+		{
+			vScreenSpacePos.x + (2.0f * (float(decal->sprite->width) * vInvScreenSize.x)) * scale.x,
+			vScreenSpacePos.y - (2.0f * (float(decal->sprite->height) * vInvScreenSize.y)) * scale.y
+		};
+
+		DecalInstance di;
+		di.decal = decal;
+		di.tint[0] = tint;
+		di.pos[0] = { vScreenSpacePos.x, vScreenSpacePos.y };
+		di.pos[1] = { vScreenSpacePos.x, vScreenSpaceDim.y };
+		di.pos[2] = { vScreenSpaceDim.x, vScreenSpaceDim.y };
+		di.pos[3] = { vScreenSpaceDim.x, vScreenSpacePos.y };
+		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+	}
+
+	void PixelGameEngine::DrawRotatedDecal(const olc::vf2d& pos, olc::Decal* decal, const float fAngle, const olc::vf2d& center, const olc::vf2d& scale, const olc::Pixel& tint)
+	{
+		DecalInstance di;
+		di.decal = decal;
+		di.tint[0] = tint;
+		di.pos[0] = (olc::vf2d(0.0f, 0.0f) - center) * scale;
+		di.pos[1] = (olc::vf2d(0.0f, float(decal->sprite->height)) - center) * scale;
+		di.pos[2] = (olc::vf2d(float(decal->sprite->width), float(decal->sprite->height)) - center) * scale;
+		di.pos[3] = (olc::vf2d(float(decal->sprite->width), 0.0f) - center) * scale;
+		float c = cos(fAngle), s = sin(fAngle);
+		for (int i = 0; i < 4; i++)
+		{
+			di.pos[i] = pos + olc::vf2d(di.pos[i].x * c - di.pos[i].y * s, di.pos[i].x * s + di.pos[i].y * c);
+			di.pos[i] = di.pos[i] * vInvScreenSize * 2.0f - olc::vf2d(1.0f, 1.0f);
+			di.pos[i].y *= -1.0f;
+		}
+		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+	}
+
+	void PixelGameEngine::DrawExplicitDecal(olc::Decal* decal, const olc::vf2d* pos, const olc::vf2d* uv, const olc::Pixel* col)
+	{
+		DecalInstance di;
+		di.decal = decal;
+		for (int i = 0; i < 4; i++)
+		{
+			di.pos[i] = { (pos[i].x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos[i].y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
+			di.uv[i] = uv[i];
+			di.tint[i] = col[i];
+		}
+		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+	}
+
+	void PixelGameEngine::FillRectDecal(const olc::vf2d& pos, const olc::vf2d& size, const olc::Pixel col)
+	{
+		std::array<olc::vf2d, 4> points = { { {pos}, {pos.x, pos.y + size.y}, {pos + size}, {pos.x + size.x, pos.y} } };
+		std::array<olc::vf2d, 4> uvs = { {{0,0},{0,0},{0,0},{0,0}} };
+		std::array<olc::Pixel, 4> cols = { {col, col, col, col} };
+		DrawExplicitDecal(nullptr, points.data(), uvs.data(), cols.data());
+	}
+
+	void PixelGameEngine::GradientFillRectDecal(const olc::vf2d& pos, const olc::vf2d& size, const olc::Pixel colTL, const olc::Pixel colBL, const olc::Pixel colBR, const olc::Pixel colTR)
+	{
+		std::array<olc::vf2d, 4> points = { { {pos}, {pos.x, pos.y + size.y}, {pos + size}, {pos.x + size.x, pos.y} } };
+		std::array<olc::vf2d, 4> uvs = { {{0,0},{0,0},{0,0},{0,0}} };
+		std::array<olc::Pixel, 4> cols = { {colTL, colBL, colBR, colTR} };
+		DrawExplicitDecal(nullptr, points.data(), uvs.data(), cols.data());
+	}
+
+
+	void PixelGameEngine::DrawPartialRotatedDecal(const olc::vf2d& pos, olc::Decal* decal, const float fAngle, const olc::vf2d& center, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::vf2d& scale, const olc::Pixel& tint)
+	{
+		DecalInstance di;
+		di.decal = decal;
+		di.tint[0] = tint;
+		di.pos[0] = (olc::vf2d(0.0f, 0.0f) - center) * scale;
+		di.pos[1] = (olc::vf2d(0.0f, source_size.y) - center) * scale;
+		di.pos[2] = (olc::vf2d(source_size.x, source_size.y) - center) * scale;
+		di.pos[3] = (olc::vf2d(source_size.x, 0.0f) - center) * scale;
+		float c = cos(fAngle), s = sin(fAngle);
+		for (int i = 0; i < 4; i++)
+		{
+			di.pos[i] = pos + olc::vf2d(di.pos[i].x * c - di.pos[i].y * s, di.pos[i].x * s + di.pos[i].y * c);
+			di.pos[i] = di.pos[i] * vInvScreenSize * 2.0f - olc::vf2d(1.0f, 1.0f);
+			di.pos[i].y *= -1.0f;
+		}
+
+		olc::vf2d uvtl = source_pos * decal->vUVScale;
+		olc::vf2d uvbr = uvtl + (source_size * decal->vUVScale);
+		di.uv[0] = { uvtl.x, uvtl.y }; di.uv[1] = { uvtl.x, uvbr.y };
+		di.uv[2] = { uvbr.x, uvbr.y }; di.uv[3] = { uvbr.x, uvtl.y };
+
+		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+	}
+
+	void PixelGameEngine::DrawPartialWarpedDecal(olc::Decal* decal, const olc::vf2d* pos, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::Pixel& tint)
+	{
+		DecalInstance di;
+		di.decal = decal;
+		di.tint[0] = tint;
+		olc::vf2d center;
+		float rd = ((pos[2].x - pos[0].x) * (pos[3].y - pos[1].y) - (pos[3].x - pos[1].x) * (pos[2].y - pos[0].y));
+		if (rd != 0)
+		{
+			olc::vf2d uvtl = source_pos * decal->vUVScale;
+			olc::vf2d uvbr = uvtl + (source_size * decal->vUVScale);
+			di.uv[0] = { uvtl.x, uvtl.y }; di.uv[1] = { uvtl.x, uvbr.y };
+			di.uv[2] = { uvbr.x, uvbr.y }; di.uv[3] = { uvbr.x, uvtl.y };
+
+			rd = 1.0f / rd;
+			float rn = ((pos[3].x - pos[1].x) * (pos[0].y - pos[1].y) - (pos[3].y - pos[1].y) * (pos[0].x - pos[1].x)) * rd;
+			float sn = ((pos[2].x - pos[0].x) * (pos[0].y - pos[1].y) - (pos[2].y - pos[0].y) * (pos[0].x - pos[1].x)) * rd;
+			if (!(rn < 0.f || rn > 1.f || sn < 0.f || sn > 1.f)) center = pos[0] + rn * (pos[2] - pos[0]);
+			float d[4];	for (int i = 0; i < 4; i++)	d[i] = (pos[i] - center).mag();
+			for (int i = 0; i < 4; i++)
+			{
+				float q = d[i] == 0.0f ? 1.0f : (d[i] + d[(i + 2) & 3]) / d[(i + 2) & 3];
+				di.uv[i] *= q; di.w[i] *= q;
+				di.pos[i] = { (pos[i].x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos[i].y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
+			}
+			vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		}
+	}
+
+	void PixelGameEngine::DrawWarpedDecal(olc::Decal* decal, const olc::vf2d* pos, const olc::Pixel& tint)
+	{
+		// Thanks Nathan Reed, a brilliant article explaining whats going on here
+		// http://www.reedbeta.com/blog/quadrilateral-interpolation-part-1/
+		DecalInstance di;
+		di.decal = decal;
+		di.tint[0] = tint;
+		olc::vf2d center;
+		float rd = ((pos[2].x - pos[0].x) * (pos[3].y - pos[1].y) - (pos[3].x - pos[1].x) * (pos[2].y - pos[0].y));
+		if (rd != 0)
+		{
+			rd = 1.0f / rd;
+			float rn = ((pos[3].x - pos[1].x) * (pos[0].y - pos[1].y) - (pos[3].y - pos[1].y) * (pos[0].x - pos[1].x)) * rd;
+			float sn = ((pos[2].x - pos[0].x) * (pos[0].y - pos[1].y) - (pos[2].y - pos[0].y) * (pos[0].x - pos[1].x)) * rd;
+			if (!(rn < 0.f || rn > 1.f || sn < 0.f || sn > 1.f)) center = pos[0] + rn * (pos[2] - pos[0]);
+			float d[4];	for (int i = 0; i < 4; i++)	d[i] = (pos[i] - center).mag();
+			for (int i = 0; i < 4; i++)
+			{
+				float q = d[i] == 0.0f ? 1.0f : (d[i] + d[(i + 2) & 3]) / d[(i + 2) & 3];
+				di.uv[i] *= q; di.w[i] *= q;
+				di.pos[i] = { (pos[i].x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos[i].y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
+			}
+			vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		}
+	}
+
+	void PixelGameEngine::DrawWarpedDecal(olc::Decal* decal, const std::array<olc::vf2d, 4>& pos, const olc::Pixel& tint)
+	{
+		DrawWarpedDecal(decal, pos.data(), tint);
+	}
+
+	void PixelGameEngine::DrawWarpedDecal(olc::Decal* decal, const olc::vf2d(&pos)[4], const olc::Pixel& tint)
+	{
+		DrawWarpedDecal(decal, &pos[0], tint);
+	}
+
+	void PixelGameEngine::DrawPartialWarpedDecal(olc::Decal* decal, const std::array<olc::vf2d, 4>& pos, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::Pixel& tint)
+	{
+		DrawPartialWarpedDecal(decal, pos.data(), source_pos, source_size, tint);
+	}
+
+	void PixelGameEngine::DrawPartialWarpedDecal(olc::Decal* decal, const olc::vf2d(&pos)[4], const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::Pixel& tint)
+	{
+		DrawPartialWarpedDecal(decal, &pos[0], source_pos, source_size, tint);
+	}
+
+	void PixelGameEngine::DrawStringDecal(const olc::vf2d& pos, const std::string& sText, const Pixel col, const olc::vf2d& scale)
+	{
+		// The whole string is one instance, see olc::ForEachDecal()
+		LayerDesc& layer = vLayers[nTargetLayer];
+		DecalGlyphRun run;
+		run.font = pUserFontDecal != nullptr ? pUserFontDecal : fontDecal;
+		run.vFontOffset = pUserFontDecal != nullptr ? vUserFontOffset : olc::vf2d(0.0f, 0.0f);
+		run.nBefore = layer.vecDecalInstance.size();
+		run.pos = pos; run.scale = scale; run.vInvScreenSize = vInvScreenSize;
+		run.tint = col;
+		run.nText = uint32_t(layer.sGlyphText.size());
+		run.nLength = uint32_t(sText.size());
+		for (const uint8_t c : sText)
+		{
+			const int32_t g = int32_t(c) - 32;
+			if (g >= 0 && g < 96) run.nGlyphs++;
+		}
+		if (run.nGlyphs == 0) return;
+
+		layer.sGlyphText += sText;
+		layer.vecGlyphRuns.push_back(run);
+	}
+
+	void PixelGameEngine::SetFontDecal(olc::Decal* decal, const olc::vi2d& vOffset)
+	{
+		pUserFontDecal = decal;
+		vUserFontOffset = vOffset;
+	}
+
+	const olc::Sprite* PixelGameEngine::GetFontSprite() const
+	{ return fontSprite; }
+
+	olc::vi2d PixelGameEngine::GetTextSize(const std::string& s)
+	{
+		olc::vi2d size = { 0,1 };
+		olc::vi2d pos = { 0,1 };
+		for (auto c : s)
+		{
+			if (c == '\n') { pos.y++;  pos.x = 0; }
+			else pos.x++;
+			size.x = std::max(size.x, pos.x);
+			size.y = std::max(size.y, pos.y);
+		}
+		return size * 8;
+	}
+
+	void PixelGameEngine::DrawString(const olc::vi2d& pos, const std::string& sText, Pixel col, uint32_t scale)
+	{
+		DrawString(pos.x, pos.y, sText, col, scale);
+	}
+
+	void PixelGameEngine::DrawString(int32_t x, int32_t y, const std::string& sText, Pixel col, uint32_t scale)
+	{
+		if (pDrawTarget == nullptr) return;
+		olc::vi2d vTextSize = GetTextSize(sText) * int32_t(scale);
+		olc_MarkDirty(x, y, vTextSize.x, vTextSize.y);
+
+		// Text ignores the pixel mode, so even custom mode can be deferred
+		if (bDeferred)
+		{
+			olc_FlushIfShared(nullptr);
+			olc_RecordDraw(DrawCommand::STRING, col, { x, y, int32_t(sDrawText.size()), int32_t(sText.size()), int32_t(scale) });
+			sDrawText += sText;
+		}
+		else
+			olc_RasterString(olc_RasterState(), x, y, sText.data(), sText.size(), col, scale);
+	}
+
+	void PixelGameEngine::olc_RasterString(const RasterState& rs, int32_t x, int32_t y, const char* sText, size_t nLength, Pixel col, uint32_t scale)
+	{
+		int32_t sx = 0;
+		int32_t sy = 0;
+		const int32_t s = scale > 1 ? int32_t(scale) : 1;
+
+		// Text is always drawn opaque or blended, whatever the pixel mode.
+		// Thanks @tucna, spotted bug with col.ALPHA :P
+		auto FillRun = [&](int32_t px, int32_t py, int32_t len)
+		{
+			if (py < rs.vClipMin.y || py >= rs.vClipMax.y) return;
+			const int32_t x0 = std::max(px, rs.vClipMin.x), x1 = std::min(px + len, rs.vClipMax.x);
+			if (x0 >= x1) return;
+			Pixel* pDst = rs.pTarget->GetData() + py * rs.pTarget->width + x0;
+			if (col.a != 255) span::FillBlend(pDst, x1 - x0, col, rs.fBlend);
+			else              span::Fill(pDst, x1 - x0, col);
+		};
+
+		for (size_t n = 0; n < nLength; n++)
+		{
+			const char c = sText[n];
+			if (c == '\n')
+			{
+				sx = 0; sy += 8 * scale;
+			}
+			else
+			{
+				// Every run of lit pixels is filled as one span per scaled row
+				const int32_t g = int32_t(c) - 32;
+				if (g >= 0 && g < 96)
+				{
+					for (uint16_t r = nGlyphRunStart[g]; r < nGlyphRunStart[g + 1]; r++)
+					{
+						const GlyphRun& run = vecGlyphRuns[r];
+						for (int32_t js = 0; js < s; js++)
+							FillRun(x + sx + run.x * s, y + sy + run.y * s + js, run.len * s);
+					}
+				}
+				sx += 8 * scale;
+			}
+		}
+	}
+
+	PixelGameEngine::RasterState PixelGameEngine::olc_RasterState()
+	{
+		return { pDrawTarget, nPixelMode, fBlendFactor, { 0, 0 }, { pDrawTarget->width, pDrawTarget->height }, &vecSpanRow };
+	}
+
+	void PixelGameEngine::EnableDeferredDrawing(bool b, uint32_t nWorkers)
+	{
+		FlushDrawing();
+		olc_StopDrawWorkers();
+		bDeferred = b;
+		if (!b) return;
+
+		if (nWorkers == 0) nWorkers = std::max(1u, std::thread::hardware_concurrency());
+		vecWorkerRows.resize(nWorkers);
+		for (uint32_t i = 0; i < nWorkers; i++)
+			vecDrawWorkers.emplace_back(&PixelGameEngine::olc_DrawWorker, this, i, nDrawGeneration);
+	}
+
+	void PixelGameEngine::FlushDrawing()
+	{
+		if (vecDrawCommands.empty()) return;
+
+		{
+			std::lock_guard<std::mutex> lock(muxDraw);
+			nDrawPending = uint32_t(vecDrawWorkers.size());
+			nDrawGeneration++;
+		}
+		cvDrawStart.notify_all();
+
+		std::unique_lock<std::mutex> lock(muxDraw);
+		cvDrawDone.wait(lock, [&] { return nDrawPending == 0; });
+		vecDrawCommands.clear();
+		sDrawText.clear();
+		vecDeferTargets.clear();
+		vecDeferSources.clear();
+	}
+
+	bool PixelGameEngine::olc_Defer(Sprite* pSource)
+	{
+		if (!bDeferred) return false;
+		// Custom pixel functions need not be thread safe, and a sprite drawn onto
+		// itself reads rows other bands write, so both are run here once
+		// everything recorded before them is drawn
+		if (nPixelMode == Pixel::CUSTOM || pSource == pDrawTarget)
+		{
+			FlushDrawing();
+			return false;
+		}
+		olc_FlushIfShared(pSource);
+		return true;
+	}
+
+	void PixelGameEngine::olc_FlushIfShared(Sprite* pSource)
+	{
+		// Bands run each command at once, so a sprite must not be read by one
+		// command while another draws into it. Those are drawn first
+		auto Pending = [](const std::vector<Sprite*>& v, const Sprite* s) { return std::find(v.begin(), v.end(), s) != v.end(); };
+		if ((pSource != nullptr && Pending(vecDeferTargets, pSource)) || Pending(vecDeferSources, pDrawTarget))
+			FlushDrawing();
+	}
+
+	void PixelGameEngine::olc_RecordDraw(uint8_t nType, Pixel p, std::initializer_list<int32_t> args, Sprite* pSprite, uint8_t nFlip)
+	{
+		DrawCommand cmd;
+		cmd.nType = nType; cmd.nMode = nPixelMode; cmd.nFlip = nFlip; cmd.p = p;
+		cmd.fBlend = fBlendFactor; cmd.pTarget = pDrawTarget; cmd.pSprite = pSprite;
+		std::copy(args.begin(), args.end(), cmd.v);
+		vecDrawCommands.push_back(cmd);
+		if (std::find(vecDeferTargets.begin(), vecDeferTargets.end(), pDrawTarget) == vecDeferTargets.end())
+			vecDeferTargets.push_back(pDrawTarget);
+		if (pSprite != nullptr && std::find(vecDeferSources.begin(), vecDeferSources.end(), pSprite) == vecDeferSources.end())
+			vecDeferSources.push_back(pSprite);
+	}
+
+	void PixelGameEngine::olc_DrawWorker(uint32_t nWorker, uint32_t nGeneration)
+	{
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(muxDraw);
+				cvDrawStart.wait(lock, [&] { return bDrawWorkersQuit || nDrawGeneration != nGeneration; });
+				if (bDrawWorkersQuit) return;
+				nGeneration = nDrawGeneration;
+			}
+
+			// Every worker runs the whole list, but only draws within its own band of
+			// rows. Each pixel still sees the commands in recorded order, so the result
+			// is the same as drawing immediately
+			const int32_t nWorkers = int32_t(vecDrawWorkers.size());
+			RasterState rs;
+			rs.pRow = &vecWorkerRows[nWorker];
+			for (const auto& cmd : vecDrawCommands)
+			{
+				rs.pTarget = cmd.pTarget; rs.nMode = cmd.nMode; rs.fBlend = cmd.fBlend;
+				rs.vClipMin = { 0, cmd.pTarget->height * int32_t(nWorker) / nWorkers };
+				rs.vClipMax = { cmd.pTarget->width, cmd.pTarget->height * int32_t(nWorker + 1) / nWorkers };
+				const int32_t* v = cmd.v;
+				switch (cmd.nType)
+				{
+				case DrawCommand::PIXEL:
+					if (v[1] >= rs.vClipMin.y && v[1] < rs.vClipMax.y)
+						olc_Plot(rs.pTarget, rs.nMode, rs.fBlend, v[0], v[1], cmd.p);
+					break;
+				case DrawCommand::CLEAR:
+					span::Fill(rs.pTarget->GetData() + rs.vClipMin.y * rs.pTarget->width, (rs.vClipMax.y - rs.vClipMin.y) * rs.pTarget->width, cmd.p);
+					break;
+				case DrawCommand::RECT: olc_RasterRect(rs, v[0], v[1], v[2], v[3], cmd.p); break;
+				case DrawCommand::TRIANGLE: olc_RasterTriangle(rs, v[0], v[1], v[2], v[3], v[4], v[5], cmd.p); break;
+				case DrawCommand::SPRITE: olc_RasterSprite(rs, v[0], v[1], cmd.pSprite, v[2], v[3], v[4], v[5], v[6], cmd.nFlip); break;
+				case DrawCommand::STRING: olc_RasterString(rs, v[0], v[1], sDrawText.data() + v[2], size_t(v[3]), cmd.p, uint32_t(v[4])); break;
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(muxDraw);
+			if (--nDrawPending == 0) cvDrawDone.notify_one();
+		}
+	}
+
+	void PixelGameEngine::olc_StopDrawWorkers()
+	{
+		{
+			std::lock_guard<std::mutex> lock(muxDraw);
+			bDrawWorkersQuit = true;
+		}
+		cvDrawStart.notify_all();
+		for (auto& t : vecDrawWorkers) t.join();
+		vecDrawWorkers.clear();
+		bDrawWorkersQuit = false;
+	}
+
+	void PixelGameEngine::SetPixelMode(Pixel::Mode m)
+	{ nPixelMode = m; }
+
+	Pixel::Mode PixelGameEngine::GetPixelMode()
+	{ return nPixelMode; }
+
+	void PixelGameEngine::SetPixelMode(std::function<olc::Pixel(const int x, const int y, const olc::Pixel&, const olc::Pixel&)> pixelMode)
+	{
+		funcPixelMode = pixelMode;
+		nPixelMode = Pixel::Mode::CUSTOM;
+	}
+
+	void PixelGameEngine::SetPixelBlend(float fBlend)
+	{
+		fBlendFactor = fBlend;
+		if (fBlendFactor < 0.0f) fBlendFactor = 0.0f;
+		if (fBlendFactor > 1.0f) fBlendFactor = 1.0f;
+	}
+
+	// User must override these functions as required. I have not made
+	// them abstract because I do need a default behaviour to occur if
+	// they are not overwritten
+
+	bool PixelGameEngine::OnUserCreate()
+	{ return false; }
+
+	bool PixelGameEngine::OnUserUpdate(float fElapsedTime)
+	{ UNUSED(fElapsedTime);  return false; }
+
+	bool PixelGameEngine::OnUserDestroy()
+	{ return true; }
+	//////////////////////////////////////////////////////////////////
+
+	void PixelGameEngine::olc_UpdateViewport()
+	{
+		int32_t ww = vScreenSize.x * vPixelSize.x;
+		int32_t wh = vScreenSize.y * vPixelSize.y;
+		float wasp = (float)ww / (float)wh;
+
+		if (bPixelCohesion)
+		{
+			vScreenPixelSize = (vWindowSize / vScreenSize);
+			vViewSize = (vWindowSize / vScreenSize) * vScreenSize;
+		}
+		else
+		{
+			vViewSize.x = (int32_t)vWindowSize.x;
+			vViewSize.y = (int32_t)((float)vViewSize.x / wasp);
+
+			if (vViewSize.y > vWindowSize.y)
+			{
+				vViewSize.y = vWindowSize.y;
+				vViewSize.x = (int32_t)((float)vViewSize.y * wasp);
+			}
+		}
+
+		vViewPos = (vWindowSize - vViewSize) / 2;
+	}
+
+	void PixelGameEngine::olc_UpdateWindowSize(int32_t x, int32_t y)
+	{
+		vWindowSize = { x, y };
+		olc_UpdateViewport();
+	}
+
+	void PixelGameEngine::olc_UpdateMouseWheel(int32_t delta)
+	{
+		nMouseWheelDeltaCache += delta;
+	}
+
+	void PixelGameEngine::olc_UpdateMouse(int32_t x, int32_t y)
+	{
+		// Mouse coords come in screen space
+		// But leave in pixel space
+		bHasMouseFocus = true;
+		vMouseWindowPos = { x, y };
+		// Full Screen mode may have a weird viewport we must clamp to
+		x -= vViewPos.x;
+		y -= vViewPos.y;
+		vMousePosCache.x = (int32_t)(((float)x / (float)(vWindowSize.x - (vViewPos.x * 2)) * (float)vScreenSize.x));
+		vMousePosCache.y = (int32_t)(((float)y / (float)(vWindowSize.y - (vViewPos.y * 2)) * (float)vScreenSize.y));
+		if (vMousePosCache.x >= (int32_t)vScreenSize.x)	vMousePosCache.x = vScreenSize.x - 1;
+		if (vMousePosCache.y >= (int32_t)vScreenSize.y)	vMousePosCache.y = vScreenSize.y - 1;
+		if (vMousePosCache.x < 0) vMousePosCache.x = 0;
+		if (vMousePosCache.y < 0) vMousePosCache.y = 0;
+	}
+
+	void PixelGameEngine::olc_UpdateMouseState(int32_t button, bool state)
+	{ pMouseNewState[button] = state; }
+
+	void PixelGameEngine::olc_UpdateKeyState(int32_t key, bool state)
+	{ pKeyNewState[key] = state; }
+
+	void PixelGameEngine::olc_UpdateMouseFocus(bool state)
+	{ bHasMouseFocus = state; }
+
+	void PixelGameEngine::olc_UpdateKeyFocus(bool state)
+	{ bHasInputFocus = state; }
+
+	void PixelGameEngine::olc_Terminate()
+	{ bAtomActive = false; }
+
+	void PixelGameEngine::EngineThread()
+	{
+		// Allow platform to do stuff here if needed, since its now in the
+		// context of this thread
+		if (platform->ThreadStartUp() == olc::FAIL)	return;
+
+		// Do engine context specific initialisation
+		olc_PrepareEngine();
+
+		// Create user resources as part of this thread
+		if (!OnUserCreate()) bAtomActive = false;
+
+		while (bAtomActive)
+		{
+			// Run as fast as possible, unless limited or idle
+			while (bAtomActive) { olc_CoreUpdate(); olc_WaitNextFrame(); }
+
+			// Allow the user to free resources if they have overrided the destroy function
+			if (!OnUserDestroy())
+			{
+				// User denied destroy for some reason, so continue running
+				bAtomActive = true;
+			}
+		}
+
+		if (pTrace != nullptr) SaveTrace();
+		platform->ThreadCleanUp();
+	}
+
+	void PixelGameEngine::olc_WaitNextFrame()
+	{
+		if (!bAtomActive) return;
+
+#if defined(OLC_PLATFORM_HEADLESS)
+		// Nothing to show, so only wait when asked to
+		if (!cfgHeadless.bWaitBetweenFrames) return;
+#endif
+
+		if (bIdle)
+		{
+			// Nothing is animating, so sleep until there is something to respond to. The
+			// timeout is only a safety net in case a wake up is missed
+			platform->WaitSystemEvent(1.0f);
+			m_tpNextFrame = std::chrono::steady_clock::now();
+			return;
+		}
+
+		if (fFrameRateLimit > 0.0f)
+		{
+			using namespace std::chrono;
+			m_tpNextFrame += duration_cast<steady_clock::duration>(duration<float>(1.0f / fFrameRateLimit));
+			auto tpNow = steady_clock::now();
+
+			// If we have fallen behind, dont try to catch up with a burst of frames
+			if (m_tpNextFrame < tpNow) { m_tpNextFrame = tpNow; return; }
+
+			// The scheduler can oversleep by a millisecond or so, so sleep most of
+			// the way and yield through the rest to hit the target precisely
+			if (m_tpNextFrame - tpNow > milliseconds(2))
+				std::this_thread::sleep_until(m_tpNextFrame - milliseconds(1));
+			while (steady_clock::now() < m_tpNextFrame)
+				std::this_thread::yield();
+		}
+	}
+
+	void PixelGameEngine::olc_PrepareEngine()
+	{
+		// Start OpenGL, the context is owned by the game thread
+		if (platform->CreateGraphics(bFullScreen, bEnableVSYNC, vViewPos, vViewSize) == olc::FAIL) return;
+
+		// Construct default font sheet
+		olc_ConstructFontSheet();
+
+		// Create Primary Layer "0"
+		CreateLayer();
+		vLayers[0].bUpdate = true;
+		vLayers[0].bShow = true;
+		SetDrawTarget(nullptr);
+
+		m_tp1 = std::chrono::system_clock::now();
+		m_tp2 = std::chrono::system_clock::now();
+		m_tpNextFrame = std::chrono::steady_clock::now();
+	}
+
+
+	void PixelGameEngine::olc_CoreUpdate()
+	{
+		// Handle Timing
+		m_tp2 = std::chrono::system_clock::now();
+		std::chrono::duration<float> elapsedTime = m_tp2 - m_tp1;
+		m_tp1 = m_tp2;
+
+		// Our time per frame coefficient
+		float fElapsedTime = elapsedTime.count();
+#if defined(OLC_PLATFORM_HEADLESS)
+		if (cfgHeadless.fFrameTime > 0.0f) fElapsedTime = cfgHeadless.fFrameTime;
+#endif
+		fLastElapsed = fElapsedTime;
+
+		// Time spent in each phase, when profiling
+		float fPhase[olc::FrameProfiler::PHASES] = { 0.0f };
+		auto tpPhase = std::chrono::steady_clock::now();
+		const auto tpFrame = tpPhase;
+		auto EndPhase = [&](uint32_t nPhase)
+		{
+			if (!bProfile && !bTrace) return;
+			const auto tp = std::chrono::steady_clock::now();
+			if (nPhase < olc::FrameProfiler::PHASES)
+			{
+				fPhase[nPhase] += std::chrono::duration<float>(tp - tpPhase).count();
+				if (bTrace) pTrace->Complete(olc::FrameProfiler::PhaseName(nPhase), tpPhase, tp);
+			}
+			tpPhase = tp;
+		};
+
+		// Some platforms will need to check for events
+		platform->HandleSystemEvent();
+		EndPhase(olc::FrameProfiler::EVENTS);
+
+		// Compare hardware input states from previous frame
+		auto ScanHardware = [&](HWButton* pKeys, bool* pStateOld, bool* pStateNew, uint32_t nKeyCount)
+		{
+			for (uint32_t i = 0; i < nKeyCount; i++)
+			{
+				pKeys[i].bPressed = false;
+				pKeys[i].bReleased = false;
+				if (pStateNew[i] != pStateOld[i])
+				{
+					if (pStateNew[i])
+					{
+						pKeys[i].bPressed = !pKeys[i].bHeld;
+						pKeys[i].bHeld = true;
+					}
+					else
+					{
+						pKeys[i].bReleased = true;
+						pKeys[i].bHeld = false;
+					}
+				}
+				pStateOld[i] = pStateNew[i];
+			}
+		};
+
+		ScanHardware(pKeyboardState, pKeyOldState, pKeyNewState, 256);
+		ScanHardware(pMouseState, pMouseOldState, pMouseNewState, nMouseButtons);
+
+		// Cache mouse coordinates so they remain consistent during frame
+		vMousePos = vMousePosCache;
+		nMouseWheelDelta = nMouseWheelDeltaCache;
+		nMouseWheelDeltaCache = 0;
+		EndPhase(olc::FrameProfiler::INPUT);
+
+		//	renderer->ClearBuffer(olc::BLACK, true);
+
+			// Handle Frame Update
+		if (!OnUserUpdate(fElapsedTime))
+			bAtomActive = false;
+
+		// Anything drawn deferred must be finished before layers are uploaded
+		FlushDrawing();
+		EndPhase(olc::FrameProfiler::UPDATE);
+
+		// The overlay is not timed, it would only measure itself
+		if (bProfileOverlay)
+		{
+			olc_DrawProfilerOverlay();
+			EndPhase(olc::FrameProfiler::PHASES);
+		}
+
+		// Display Frame
+		renderer->UpdateViewport(vViewPos, vViewSize);
+		renderer->ClearBuffer(olc::BLACK, true);
+
+		// Layer 0 must always exist, and unless only drawn areas are
+		// being tracked, it is assumed to have changed every frame
+		if (!bDirtyTracking) vLayers[0].bUpdate = true;
+		vLayers[0].bShow = true;
+		renderer->PrepareDrawing();
+		EndPhase(olc::FrameProfiler::DRAW);
+
+		for (auto layer = vLayers.rbegin(); layer != vLayers.rend(); ++layer)
+		{
+			if (layer->bShow)
+			{
+				if (layer->funcHook == nullptr)
+				{
+					renderer->ApplyTexture(layer->nResID);
+					if (layer->bUpdate)
+					{
+						renderer->UpdateTexture(layer->nResID, layer->pDrawTarget);
+						layer->bUpdate = false;
+					}
+					else if (bDirtyTracking)
+					{
+						// Only upload the area that was drawn to, clipped to the layer
+						olc::vi2d vMin = { std::max(layer->vDirtyMin.x, 0), std::max(layer->vDirtyMin.y, 0) };
+						olc::vi2d vMax = { std::min(layer->vDirtyMax.x, layer->pDrawTarget->width - 1), std::min(layer->vDirtyMax.y, layer->pDrawTarget->height - 1) };
+						if (vMin.x <= vMax.x && vMin.y <= vMax.y)
+							renderer->UpdateTextureRegion(layer->nResID, layer->pDrawTarget, vMin, vMax - vMin + olc::vi2d(1, 1));
+					}
+					layer->vDirtyMin = { INT32_MAX, INT32_MAX };
+					layer->vDirtyMax = { INT32_MIN, INT32_MIN };
+					EndPhase(olc::FrameProfiler::UPLOAD);
+
+					renderer->DrawLayerQuad(layer->vOffset, layer->vScale, layer->tint);
+
+					// Display Decals in order for this layer
+					renderer->DrawDecalQuads(*layer);
+					layer->vecDecalInstance.clear();
+					layer->vecGlyphRuns.clear();
+					layer->sGlyphText.clear();
+				}
+				else
+				{
+					// Mwa ha ha.... Have Fun!!!
+					layer->funcHook();
+				}
+			}
+			EndPhase(olc::FrameProfiler::DRAW);
+		}
+
+		// Present Graphics to screen
+		renderer->DisplayFrame();
+		EndPhase(olc::FrameProfiler::DISPLAY);
+		if (bProfile) pProfiler->EndFrame(fPhase);
+		if (bTrace) pTrace->Complete("Frame", tpFrame, std::chrono::steady_clock::now());
+
+		// Update Title Bar
+		fFrameTimer += fElapsedTime;
+		nFrameCount++;
+		if (fFrameTimer >= 1.0f)
+		{
+			nLastFPS = nFrameCount;
+			fFrameTimer -= 1.0f;
+			std::string sTitle = "OneLoneCoder.com - Pixel Game Engine - " + sAppName + " - FPS: " + std::to_string(nFrameCount);
+			platform->SetWindowTitle(sTitle);
+			nFrameCount = 0;
+		}
+	}
+
+	void PixelGameEngine::olc_ConstructFontSheet()
+	{
+		std::string data;
+		data += "?Q`0001oOch0o01o@F40o0<AGD4090LAGD<090@A7ch0?00O7Q`0600>00000000";
+		data += "O000000nOT0063Qo4d8>?7a14Gno94AA4gno94AaOT0>o3`oO400o7QN00000400";
+		data += "Of80001oOg<7O7moBGT7O7lABET024@aBEd714AiOdl717a_=TH013Q>00000000";
+		data += "720D000V?V5oB3Q_HdUoE7a9@DdDE4A9@DmoE4A;Hg]oM4Aj8S4D84@`00000000";
+		data += "OaPT1000Oa`^13P1@AI[?g`1@A=[OdAoHgljA4Ao?WlBA7l1710007l100000000";
+		data += "ObM6000oOfMV?3QoBDD`O7a0BDDH@5A0BDD<@5A0BGeVO5ao@CQR?5Po00000000";
+		data += "Oc``000?Ogij70PO2D]??0Ph2DUM@7i`2DTg@7lh2GUj?0TO0C1870T?00000000";
+		data += "70<4001o?P<7?1QoHg43O;`h@GT0@:@LB@d0>:@hN@L0@?aoN@<0O7ao0000?000";
+		data += "OcH0001SOglLA7mg24TnK7ln24US>0PL24U140PnOgl0>7QgOcH0K71S0000A000";
+		data += "00H00000@Dm1S007@DUSg00?OdTnH7YhOfTL<7Yh@Cl0700?@Ah0300700000000";
+		data += "<008001QL00ZA41a@6HnI<1i@FHLM81M@@0LG81?O`0nC?Y7?`0ZA7Y300080000";
+		data += "O`082000Oh0827mo6>Hn?Wmo?6HnMb11MP08@C11H`08@FP0@@0004@000000000";
+		data += "00P00001Oab00003OcKP0006@6=PMgl<@440MglH@000000`@000001P00000000";
+		data += "Ob@8@@00Ob@8@Ga13R@8Mga172@8?PAo3R@827QoOb@820@0O`0007`0000007P0";
+		data += "O`000P08Od400g`<3V=P0G`673IP0`@3>1`00P@6O`P00g`<O`000GP800000000";
+		data += "?P9PL020O`<`N3R0@E4HC7b0@ET<ATB0@@l6C4B0O`H3N7b0?P01L3R000000020";
+
+		fontSprite = new olc::Sprite(128, 48);
+		int px = 0, py = 0;
+		for (size_t b = 0; b < 1024; b += 4)
+		{
+			uint32_t sym1 = (uint32_t)data[b + 0] - 48;
+			uint32_t sym2 = (uint32_t)data[b + 1] - 48;
+			uint32_t sym3 = (uint32_t)data[b + 2] - 48;
+			uint32_t sym4 = (uint32_t)data[b + 3] - 48;
+			uint32_t r = sym1 << 18 | sym2 << 12 | sym3 << 6 | sym4;
+
+			for (int i = 0; i < 24; i++)
+			{
+				int k = r & (1 << i) ? 255 : 0;
+				fontSprite->SetPixel(px, py, olc::Pixel(k, k, k, k));
+				if (++py == 48) { px++; py = 0; }
+			}
+		}
+
+		fontDecal = new olc::Decal(fontSprite);
+
+		vecGlyphRuns.clear();
+		for (int32_t g = 0; g < 96; g++)
+		{
+			nGlyphRunStart[g] = uint16_t(vecGlyphRuns.size());
+			for (int32_t j = 0; j < 8; j++)
+			{
+				const Pixel* pGlyph = fontSprite->GetData() + (j + (g / 16) * 8) * fontSprite->width + (g % 16) * 8;
+				for (int32_t i = 0; i < 8; i++)
+				{
+					if (pGlyph[i].r == 0) continue;
+					int32_t i1 = i + 1;
+					while (i1 < 8 && pGlyph[i1].r > 0) i1++;
+					vecGlyphRuns.push_back({ uint8_t(i), uint8_t(j), uint8_t(i1 - i) });
+					i = i1;
+				}
+			}
+		}
+		nGlyphRunStart[96] = uint16_t(vecGlyphRuns.size());
+	}
+
+	// Need a couple of statics as these are singleton instances
+	// read from multiple locations
+	std::atomic<bool> PixelGameEngine::bAtomActive{ false };
+	olc::PixelGameEngine* olc::PGEX::pge = nullptr;
+	olc::PixelGameEngine* olc::Platform::ptrPGE = nullptr;
+	olc::PixelGameEngine* olc::Renderer::ptrPGE = nullptr;
+	std::unique_ptr<ImageLoader> olc::Sprite::loader = nullptr;
+};
+
+
+
+// O------------------------------------------------------------------------------O
+// | olcPixelGameEngine PLATFORM SPECIFIC IMPLEMENTATIONS                         |
+// O------------------------------------------------------------------------------O
+
+// O------------------------------------------------------------------------------O
+// | START RENDERER: OpenGL 1.0 (the original, the best...)                       |
+// O------------------------------------------------------------------------------O
+#if defined(OLC_GFX_OPENGL10)
+	#if defined(_WIN32)
+	#include <windows.h>
+	#include <dwmapi.h>
+	#include <GL/gl.h>
+	#pragma comment(lib, "Dwmapi.lib")
+	typedef BOOL(WINAPI wglSwapInterval_t) (int interval);
+	static wglSwapInterval_t* wglSwapInterval = nullptr;
+	typedef HDC glDeviceContext_t;
+	typedef HGLRC glRenderContext_t;
+#endif
+
+#if (defined(__linux__) || defined(__FreeBSD__)) && !defined(OLC_PLATFORM_HEADLESS)
+	#include <GL/gl.h>
+	namespace X11
+	{
+		#include <GL/glx.h>
+		#include <X11/X.h>
+		#include <X11/Xlib.h>
+	}
+
+	typedef int(glSwapInterval_t)(X11::Display* dpy, X11::GLXDrawable drawable, int interval);
+	static glSwapInterval_t* glSwapIntervalEXT;
+	typedef X11::GLXContext glDeviceContext_t;
+	typedef X11::GLXContext glRenderContext_t;
+#endif
+
+#if defined(OLC_PLATFORM_HEADLESS)
+	#include <EGL/egl.h>
+	#include <EGL/eglext.h>
+	#include <GL/gl.h>
+	typedef EGLContext glDeviceContext_t;
+	typedef EGLContext glRenderContext_t;
+
+namespace olc
+{
+	// An EGL context with no surface for the OpenGL renderers on the headless
+	// platform, frames are drawn into a framebuffer object the size of the window
+	class HeadlessGLContext
+	{
+	public:
+		olc::rcode Create(bool bCoreProfile, const olc::vi2d& vSize)
+		{
+			typedef EGLDisplay locGetPlatformDisplay_t(EGLenum platform, void* native, const EGLint* attribs);
+			auto locGetPlatformDisplay = (locGetPlatformDisplay_t*)eglGetProcAddress("eglGetPlatformDisplayEXT");
+			if (locGetPlatformDisplay != nullptr)
+				eglDisplay = locGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+			if (eglDisplay == EGL_NO_DISPLAY) eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+			if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, nullptr, nullptr)) return olc::FAIL;
+			if (!eglBindAPI(EGL_OPENGL_API)) return olc::FAIL;
+
+			// Nothing is drawn to a surface, any config will do
+			const EGLint nConfigAttribs[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+			const EGLint nCoreAttribs[] =
+			{
+				EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+				EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE
+			};
+			EGLConfig config = EGL_NO_CONFIG_KHR;
+			EGLint nConfigs = 0;
+			if (!eglChooseConfig(eglDisplay, nConfigAttribs, &config, 1, &nConfigs) || nConfigs == 0) config = EGL_NO_CONFIG_KHR;
+			eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, bCoreProfile ? nCoreAttribs : nullptr);
+			if (eglContext == EGL_NO_CONTEXT) return olc::FAIL;
+			if (!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext)) return olc::FAIL;
+
+			locGenFramebuffers = (locGenObjects_t*)eglGetProcAddress("glGenFramebuffers");
+			locDeleteFramebuffers = (locDeleteObjects_t*)eglGetProcAddress("glDeleteFramebuffers");
+			locBindFramebuffer = (locBindObject_t*)eglGetProcAddress("glBindFramebuffer");
+			locGenRenderbuffers = (locGenObjects_t*)eglGetProcAddress("glGenRenderbuffers");
+			locDeleteRenderbuffers = (locDeleteObjects_t*)eglGetProcAddress("glDeleteRenderbuffers");
+			locBindRenderbuffer = (locBindObject_t*)eglGetProcAddress("glBindRenderbuffer");
+			locRenderbufferStorage = (locRenderbufferStorage_t*)eglGetProcAddress("glRenderbufferStorage");
+			locFramebufferRenderbuffer = (locFramebufferRenderbuffer_t*)eglGetProcAddress("glFramebufferRenderbuffer");
+			locCheckFramebufferStatus = (locCheckFramebufferStatus_t*)eglGetProcAddress("glCheckFramebufferStatus");
+			if (!locGenFramebuffers || !locDeleteFramebuffers || !locBindFramebuffer || !locGenRenderbuffers || !locDeleteRenderbuffers
+				|| !locBindRenderbuffer || !locRenderbufferStorage || !locFramebufferRenderbuffer || !locCheckFramebufferStatus)
+				return olc::FAIL;
+
+			vFrameSize = vSize;
+			locGenRenderbuffers(1, &nColourBuffer);
+			locBindRenderbuffer(RENDERBUFFER, nColourBuffer);
+			locRenderbufferStorage(RENDERBUFFER, RGBA8, vSize.x, vSize.y);
+			locGenFramebuffers(1, &nFramebuffer);
+			locBindFramebuffer(FRAMEBUFFER, nFramebuffer);
+			locFramebufferRenderbuffer(FRAMEBUFFER, COLOR_ATTACHMENT0, RENDERBUFFER, nColourBuffer);
+			if (locCheckFramebufferStatus(FRAMEBUFFER) != FRAMEBUFFER_COMPLETE) return olc::FAIL;
+			glViewport(0, 0, vSize.x, vSize.y);
+			return olc::OK;
+		}
+
+		void Destroy()
+		{
+			if (eglContext != EGL_NO_CONTEXT)
+			{
+				if (nFramebuffer != 0) locDeleteFramebuffers(1, &nFramebuffer);
+				if (nColourBuffer != 0) locDeleteRenderbuffers(1, &nColourBuffer);
+				eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+				eglDestroyContext(eglDisplay, eglContext);
+			}
+			if (eglDisplay != EGL_NO_DISPLAY) eglTerminate(eglDisplay);
+			nFramebuffer = nColourBuffer = 0;
+			eglContext = EGL_NO_CONTEXT;
+			eglDisplay = EGL_NO_DISPLAY;
+		}
+
+		// Reads the framebuffer back, once the context is gone this is the
+		// last frame that was read
+		const olc::Sprite* ReadFrame()
+		{
+			if (eglContext == EGL_NO_CONTEXT) return sprFrame.get();
+			if (sprFrame == nullptr) sprFrame = std::make_unique<olc::Sprite>(vFrameSize.x, vFrameSize.y);
+			glPixelStorei(GL_PACK_ALIGNMENT, 4);
+			glReadPixels(0, 0, vFrameSize.x, vFrameSize.y, GL_RGBA, GL_UNSIGNED_BYTE, sprFrame->GetData());
+
+			// OpenGL rows run bottom up
+			olc::Pixel* pData = sprFrame->GetData();
+			for (int y = 0; y < vFrameSize.y / 2; y++)
+				std::swap_ranges(pData + y * vFrameSize.x, pData + (y + 1) * vFrameSize.x, pData + (vFrameSize.y - 1 - y) * vFrameSize.x);
+			return sprFrame.get();
+		}
+
+	private:
+		typedef void locGenObjects_t(GLsizei n, GLuint* ids);
+		typedef void locDeleteObjects_t(GLsizei n, const GLuint* ids);
+		typedef void locBindObject_t(GLenum target, GLuint id);
+		typedef void locRenderbufferStorage_t(GLenum target, GLenum format, GLsizei width, GLsizei height);
+		typedef void locFramebufferRenderbuffer_t(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
+		typedef GLenum locCheckFramebufferStatus_t(GLenum target);
+		static constexpr GLenum FRAMEBUFFER = 0x8D40;
+		static constexpr GLenum RENDERBUFFER = 0x8D41;
+		static constexpr GLenum RGBA8 = 0x8058;
+		static constexpr GLenum COLOR_ATTACHMENT0 = 0x8CE0;
+		static constexpr GLenum FRAMEBUFFER_COMPLETE = 0x8CD5;
+		locGenObjects_t* locGenFramebuffers = nullptr;
+		locDeleteObjects_t* locDeleteFramebuffers = nullptr;
+		locBindObject_t* locBindFramebuffer = nullptr;
+		locGenObjects_t* locGenRenderbuffers = nullptr;
+		locDeleteObjects_t* locDeleteRenderbuffers = nullptr;
+		locBindObject_t* locBindRenderbuffer = nullptr;
+		locRenderbufferStorage_t* locRenderbufferStorage = nullptr;
+		locFramebufferRenderbuffer_t* locFramebufferRenderbuffer = nullptr;
+		locCheckFramebufferStatus_t* locCheckFramebufferStatus = nullptr;
+
+		EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+		EGLContext eglContext = EGL_NO_CONTEXT;
+		GLuint nFramebuffer = 0;
+		GLuint nColourBuffer = 0;
+		olc::vi2d vFrameSize;
+		std::unique_ptr<olc::Sprite> sprFrame;
+	};
+}
+#endif
+
+// Pixel Buffer Objects are not part of OpenGL 1.0, so when requested
+// with OLC_GFX_OPENGL10_PBO the few functions needed are loaded at runtime
+#if defined(OLC_GFX_OPENGL10_PBO) && !defined(__APPLE__)
+	#define PGE_OGL10_USE_PBO
+	#if defined(_WIN32)
+		#define CALLSTYLE __stdcall
+	#else
+		#define CALLSTYLE
+	#endif
+	typedef void CALLSTYLE locGenBuffers_t(GLsizei n, GLuint* buffers);
+	typedef void CALLSTYLE locDeleteBuffers_t(GLsizei n, const GLuint* buffers);
+	typedef void CALLSTYLE locBindBuffer_t(GLenum target, GLuint buffer);
+	typedef void CALLSTYLE locBufferData_t(GLenum target, ptrdiff_t size, const void* data, GLenum usage);
+	typedef void* CALLSTYLE locMapBuffer_t(GLenum target, GLenum access);
+	typedef GLboolean CALLSTYLE locUnmapBuffer_t(GLenum target);
+#endif
+
+#if defined(__APPLE__)
+	#define GL_SILENCE_DEPRECATION
+	#include <GLUT/glut.h>
+	#include <OpenGL/OpenGL.h>
+	#include <OpenGL/gl.h>
+	#include <OpenGL/glu.h>
+#endif
+
+namespace olc
+{
+	class Renderer_OGL10 : public olc::Renderer
+	{
+	private:
+#if defined(__APPLE__)
+		bool mFullScreen = false;
+#else
+		glDeviceContext_t glDeviceContext = 0;
+		glRenderContext_t glRenderContext = 0;
+#endif
+
+		bool bSync = false;
+
+		// Size of the storage allocated for each texture, so uploads of the
+		// same size only replace contents and never reallocate
+		std::map<uint32_t, olc::vi2d> mapTextureSize;
+
+		// Decal vertices for a whole layer, and the texture of each quad, kept
+		// between frames to avoid reallocating
+		struct locVertex { float pos[2]; float tex[4]; olc::Pixel col; };
+		std::vector<locVertex> vecDecalVertices;
+		std::vector<uint32_t> vecQuadTexture;
+
+#if defined(PGE_OGL10_USE_PBO)
+		static constexpr GLenum PIXEL_UNPACK_BUFFER = 0x88EC;
+		static constexpr GLenum STREAM_DRAW = 0x88E0;
+		static constexpr GLenum WRITE_ONLY = 0x88B9;
+		locGenBuffers_t* locGenBuffers = nullptr;
+		locDeleteBuffers_t* locDeleteBuffers = nullptr;
+		locBindBuffer_t* locBindBuffer = nullptr;
+		locBufferData_t* locBufferData = nullptr;
+		locMapBuffer_t* locMapBuffer = nullptr;
+		locUnmapBuffer_t* locUnmapBuffer = nullptr;
+		bool bUsePBO = false;
+		GLuint nPBO[2] = { 0, 0 };
+		int nPBOIndex = 0;
+#endif
+
+#if (defined(__linux__) || defined(__FreeBSD__)) && !defined(OLC_PLATFORM_HEADLESS)
+		X11::Display* olc_Display = nullptr;
+		X11::Window* olc_Window = nullptr;
+		X11::XVisualInfo* olc_VisualInfo = nullptr;
+#endif
+
+#if defined(OLC_PLATFORM_HEADLESS)
+		olc::HeadlessGLContext glHeadless;
+#endif
+
+	public:
+		void PrepareDevice() override
+		{ 
+#if defined(__APPLE__)
+			//glutInit has to be called with main() arguments, make fake ones
+			int argc = 0;
+			char* argv[1] = { (char*)"" };
+			glutInit(&argc, argv);
+
+			glutInitWindowPosition(0, 0);
+			glutInitWindowSize(512, 512);
+
+			glutInitDisplayMode(GLUT_DOUBLE | GLUT_DEPTH | GLUT_RGBA);
+
+			// Creates the window and the OpenGL context for it
+			glutCreateWindow("OneLoneCoder.com - Pixel Game Engine");
+
+			glEnable(GL_TEXTURE_2D); // Turn on texturing
+			glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
+#endif
+		}
+
+		olc::rcode CreateDevice(std::vector<void*> params, bool bFullScreen, bool bVSYNC) override
+		{
+#if defined(_WIN32)
+			// Create Device Context
+			glDeviceContext = GetDC((HWND)(params[0]));
+			PIXELFORMATDESCRIPTOR pfd =
+			{
+				sizeof(PIXELFORMATDESCRIPTOR), 1,
+				PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER,
+				PFD_TYPE_RGBA, 32, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+				PFD_MAIN_PLANE, 0, 0, 0, 0
+			};
+
+			int pf = 0;
+			if (!(pf = ChoosePixelFormat(glDeviceContext, &pfd))) return olc::FAIL;
+			SetPixelFormat(glDeviceContext, pf, &pfd);
+
+			if (!(glRenderContext = wglCreateContext(glDeviceContext))) return olc::FAIL;
+			wglMakeCurrent(glDeviceContext, glRenderContext);
+
+			// Remove Frame cap
+			wglSwapInterval = (wglSwapInterval_t*)wglGetProcAddress("wglSwapIntervalEXT");
+			if (wglSwapInterval && !bVSYNC) wglSwapInterval(0);
+			bSync = bVSYNC;
+#endif
+
+#if defined(OLC_PLATFORM_HEADLESS)
+			UNUSED(params);
+			if (glHeadless.Create(false, ptrPGE->GetWindowSize()) != olc::OK) return olc::FAIL;
+			bSync = bVSYNC;
+#endif
+
+#if (defined(__linux__) || defined(__FreeBSD__)) && !defined(OLC_PLATFORM_HEADLESS)
+			using namespace X11;
+			// Linux has tighter coupling between OpenGL and X11, so we store
+			// various "platform" handles in the renderer
+			olc_Display = (X11::Display*)(params[0]);
+			olc_Window = (X11::Window*)(params[1]);
+			olc_VisualInfo = (X11::XVisualInfo*)(params[2]);
+
+			glDeviceContext = glXCreateContext(olc_Display, olc_VisualInfo, nullptr, GL_TRUE);
+			glXMakeCurrent(olc_Display, *olc_Window, glDeviceContext);
+
+			XWindowAttributes gwa;
+			XGetWindowAttributes(olc_Display, *olc_Window, &gwa);
+			glViewport(0, 0, gwa.width, gwa.height);
+
+			glSwapIntervalEXT = nullptr;
+			glSwapIntervalEXT = (glSwapInterval_t*)glXGetProcAddress((unsigned char*)"glXSwapIntervalEXT");
+
+			if (glSwapIntervalEXT == nullptr && !bVSYNC)
+			{
+				printf("NOTE: Could not disable VSYNC, glXSwapIntervalEXT() was not found!\n");
+				printf("      Don't worry though, things will still work, it's just the\n");
+				printf("      frame rate will be capped to your monitors refresh rate - javidx9\n");
+			}
+
+			if (glSwapIntervalEXT != nullptr && !bVSYNC)
+				glSwapIntervalEXT(olc_Display, *olc_Window, 0);
+#endif		
+
+#if defined(__APPLE__)
+			mFullScreen = bFullScreen;
+			if (!bVSYNC)
+			{
+				GLint sync = 0;
+				CGLContextObj ctx = CGLGetCurrentContext();
+				if (ctx) CGLSetParameter(ctx, kCGLCPSwapInterval, &sync);
+			}
+#else
+			glEnable(GL_TEXTURE_2D); // Turn on texturing
+			glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
+#endif
+
+#if defined(PGE_OGL10_USE_PBO)
+			// Two buffers are used in turn, so while the driver is still copying
+			// from one, the next upload can be written into the other
+#if defined(_WIN32)
+			auto GetProc = [](const char* name) { return (void*)wglGetProcAddress(name); };
+#elif defined(OLC_PLATFORM_HEADLESS)
+			auto GetProc = [](const char* name) { return (void*)eglGetProcAddress(name); };
+#else
+			auto GetProc = [](const char* name) { return (void*)X11::glXGetProcAddress((const unsigned char*)name); };
+#endif
+			locGenBuffers = (locGenBuffers_t*)GetProc("glGenBuffers");
+			locDeleteBuffers = (locDeleteBuffers_t*)GetProc("glDeleteBuffers");
+			locBindBuffer = (locBindBuffer_t*)GetProc("glBindBuffer");
+			locBufferData = (locBufferData_t*)GetProc("glBufferData");
+			locMapBuffer = (locMapBuffer_t*)GetProc("glMapBuffer");
+			locUnmapBuffer = (locUnmapBuffer_t*)GetProc("glUnmapBuffer");
+			bUsePBO = locGenBuffers && locDeleteBuffers && locBindBuffer && locBufferData && locMapBuffer && locUnmapBuffer;
+			if (bUsePBO) locGenBuffers(2, nPBO);
+#endif
+			return olc::rcode::OK;
+		}
+
+		olc::rcode DestroyDevice() override
+		{
+#if defined(PGE_OGL10_USE_PBO)
+			if (bUsePBO) locDeleteBuffers(2, nPBO);
+			bUsePBO = false;
+#endif
+
+#if defined(_WIN32)
+			wglDeleteContext(glRenderContext);
+#endif
+
+#if (defined(__linux__) || defined(__FreeBSD__)) && !defined(OLC_PLATFORM_HEADLESS)
+			glXMakeCurrent(olc_Display, None, NULL);
+			glXDestroyContext(olc_Display, glDeviceContext);
+#endif
+
+#if defined(OLC_PLATFORM_HEADLESS)
+			glHeadless.Destroy();
+#endif
+
+#if defined(__APPLE__)
+			glutDestroyWindow(glutGetWindow());
+#endif
+			return olc::rcode::OK;
+		}
+
+		void DisplayFrame() override
+		{
+#if defined(_WIN32)
+			SwapBuffers(glDeviceContext);
+			if (bSync) DwmFlush(); // Woooohooooooo!!!! SMOOOOOOOTH!
+#endif	
+
+#if (defined(__linux__) || defined(__FreeBSD__)) && !defined(OLC_PLATFORM_HEADLESS)
+			X11::glXSwapBuffers(olc_Display, *olc_Window);
+#endif		
+
+#if defined(OLC_PLATFORM_HEADLESS)
+			// Nothing is presented, wait for the frame so timings include drawing it
+			glFinish();
+#endif
+
+#if defined(__APPLE__)
+			glutSwapBuffers();
+#endif
+		}
+
+#if defined(OLC_PLATFORM_HEADLESS)
+		const olc::Sprite* GetFrame() override
+		{
+			return glHeadless.ReadFrame();
+		}
+#endif
+
+		void PrepareDrawing() override
+		{
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		}
+
+		void DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) override
+		{
+			glBegin(GL_QUADS);
+			glColor4ub(tint.r, tint.g, tint.b, tint.a);
+			glTexCoord2f(0.0f * scale.x + offset.x, 1.0f * scale.y + offset.y);
+			glVertex3f(-1.0f /*+ vSubPixelOffset.x*/, -1.0f /*+ vSubPixelOffset.y*/, 0.0f);
+			glTexCoord2f(0.0f * scale.x + offset.x, 0.0f * scale.y + offset.y);
+			glVertex3f(-1.0f /*+ vSubPixelOffset.x*/, 1.0f /*+ vSubPixelOffset.y*/, 0.0f);
+			glTexCoord2f(1.0f * scale.x + offset.x, 0.0f * scale.y + offset.y);
+			glVertex3f(1.0f /*+ vSubPixelOffset.x*/, 1.0f /*+ vSubPixelOffset.y*/, 0.0f);
+			glTexCoord2f(1.0f * scale.x + offset.x, 1.0f * scale.y + offset.y);
+			glVertex3f(1.0f /*+ vSubPixelOffset.x*/, -1.0f /*+ vSubPixelOffset.y*/, 0.0f);
+			glEnd();
+		}
+
+		void DrawDecalQuad(const olc::DecalInstance& decal) override
+		{
+			if (decal.decal == nullptr)
+			{
+				glBindTexture(GL_TEXTURE_2D, 0);
+				glBegin(GL_QUADS);
+				glColor4ub(decal.tint[0].r, decal.tint[0].g, decal.tint[0].b, decal.tint[0].a);
+				glTexCoord4f(decal.uv[0].x, decal.uv[0].y, 0.0f, decal.w[0]); glVertex2f(decal.pos[0].x, decal.pos[0].y);
+				glColor4ub(decal.tint[1].r, decal.tint[1].g, decal.tint[1].b, decal.tint[1].a);
+				glTexCoord4f(decal.uv[1].x, decal.uv[1].y, 0.0f, decal.w[1]); glVertex2f(decal.pos[1].x, decal.pos[1].y);
+				glColor4ub(decal.tint[2].r, decal.tint[2].g, decal.tint[2].b, decal.tint[2].a);
+				glTexCoord4f(decal.uv[2].x, decal.uv[2].y, 0.0f, decal.w[2]); glVertex2f(decal.pos[2].x, decal.pos[2].y);
+				glColor4ub(decal.tint[3].r, decal.tint[3].g, decal.tint[3].b, decal.tint[3].a);
+				glTexCoord4f(decal.uv[3].x, decal.uv[3].y, 0.0f, decal.w[3]); glVertex2f(decal.pos[3].x, decal.pos[3].y);
+				glEnd();
+			}
+			else
+			{
+				glBindTexture(GL_TEXTURE_2D, decal.decal->id);
+				glBegin(GL_QUADS);
+				glColor4ub(decal.tint[0].r, decal.tint[0].g, decal.tint[0].b, decal.tint[0].a);
+				glTexCoord4f(decal.uv[0].x, decal.uv[0].y, 0.0f, decal.w[0]); glVertex2f(decal.pos[0].x, decal.pos[0].y);
+				glTexCoord4f(decal.uv[1].x, decal.uv[1].y, 0.0f, decal.w[1]); glVertex2f(decal.pos[1].x, decal.pos[1].y);
+				glTexCoord4f(decal.uv[2].x, decal.uv[2].y, 0.0f, decal.w[2]); glVertex2f(decal.pos[2].x, decal.pos[2].y);
+				glTexCoord4f(decal.uv[3].x, decal.uv[3].y, 0.0f, decal.w[3]); glVertex2f(decal.pos[3].x, decal.pos[3].y);
+				glEnd();
+			}
+		}
+
+		void DrawDecalQuads(const olc::LayerDesc& layer) override
+		{
+			const size_t nQuads = olc::DecalCount(layer);
+			if (nQuads == 0) return;
+
+			// Pack every decal of the layer, text included, into one vertex array. Note
+			// untextured decals are shaded per vertex, textured ones by their first tint only
+			vecDecalVertices.resize(nQuads * 4);
+			vecQuadTexture.resize(nQuads);
+			locVertex* v = vecDecalVertices.data();
+			uint32_t* t = vecQuadTexture.data();
+			olc::ForEachDecal(layer, [&](const olc::DecalInstance& decal)
+			{
+				for (int i = 0; i < 4; i++, v++)
+				{
+					v->pos[0] = decal.pos[i].x; v->pos[1] = decal.pos[i].y;
+					v->tex[0] = decal.uv[i].x; v->tex[1] = decal.uv[i].y; v->tex[2] = 0.0f; v->tex[3] = decal.w[i];
+					v->col = decal.decal == nullptr ? decal.tint[i] : decal.tint[0];
+				}
+				*t++ = decal.decal == nullptr ? 0 : decal.decal->id;
+			});
+
+			glEnableClientState(GL_VERTEX_ARRAY);
+			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+			glEnableClientState(GL_COLOR_ARRAY);
+			glVertexPointer(2, GL_FLOAT, sizeof(locVertex), &vecDecalVertices[0].pos);
+			glTexCoordPointer(4, GL_FLOAT, sizeof(locVertex), &vecDecalVertices[0].tex);
+			glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(locVertex), &vecDecalVertices[0].col);
+
+			// Decals are not reordered, as overlapping decals must blend in the order
+			// they were drawn, so one draw is issued per run of the same texture
+			size_t nRunStart = 0;
+			for (size_t i = 1; i <= nQuads; i++)
+			{
+				const uint32_t nRunTexture = vecQuadTexture[nRunStart];
+				if (i < nQuads && vecQuadTexture[i] == nRunTexture)
+					continue;
+
+				glBindTexture(GL_TEXTURE_2D, nRunTexture);
+				glDrawArrays(GL_QUADS, GLint(nRunStart * 4), GLsizei((i - nRunStart) * 4));
+				nRunStart = i;
+			}
+
+			glDisableClientState(GL_COLOR_ARRAY);
+			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+			glDisableClientState(GL_VERTEX_ARRAY);
+		}
+
+		uint32_t CreateTexture(const uint32_t width, const uint32_t height) override
+		{
+			uint32_t id = 0;
+			glGenTextures(1, &id);
+			glBindTexture(GL_TEXTURE_2D, id);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+			glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+			// Allocate storage up front, later updates just replace the contents
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			mapTextureSize[id] = { int32_t(width), int32_t(height) };
+			return id;
+		}
+
+		uint32_t DeleteTexture(const uint32_t id) override
+		{
+			glDeleteTextures(1, &id);
+			mapTextureSize.erase(id);
+			return id;
+		}
+
+		void UpdateTexture(uint32_t id, olc::Sprite* spr) override
+		{
+			UpdateTextureRegion(id, spr, { 0, 0 }, { spr->width, spr->height });
+		}
+
+		void UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) override
+		{
+			// Note: like UpdateTexture, this acts on the currently applied texture
+			olc::vi2d& vStorage = mapTextureSize[id];
+			if (vStorage.x != spr->width || vStorage.y != spr->height)
+			{
+				// Sprite has changed size, so storage has to be reallocated anyway
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, spr->width, spr->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
+				vStorage = { spr->width, spr->height };
+				return;
+			}
+
+			if (size.x <= 0 || size.y <= 0) return;
+			const olc::Pixel* pSrc = spr->GetData() + pos.y * spr->width + pos.x;
+
+#if defined(PGE_OGL10_USE_PBO)
+			if (bUsePBO)
+			{
+				nPBOIndex = (nPBOIndex + 1) % 2;
+				locBindBuffer(PIXEL_UNPACK_BUFFER, nPBO[nPBOIndex]);
+				// Orphan the old storage, so mapping never waits on an upload in flight
+				locBufferData(PIXEL_UNPACK_BUFFER, ptrdiff_t(size.x) * size.y * sizeof(olc::Pixel), nullptr, STREAM_DRAW);
+				olc::Pixel* pDst = (olc::Pixel*)locMapBuffer(PIXEL_UNPACK_BUFFER, WRITE_ONLY);
+				if (pDst != nullptr)
+				{
+					for (int32_t y = 0; y < size.y; y++)
+						std::memcpy(pDst + y * size.x, pSrc + y * spr->width, size.x * sizeof(olc::Pixel));
+					locUnmapBuffer(PIXEL_UNPACK_BUFFER);
+					glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+					locBindBuffer(PIXEL_UNPACK_BUFFER, 0);
+					return;
+				}
+				locBindBuffer(PIXEL_UNPACK_BUFFER, 0);
+			}
+#endif
+
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, spr->width);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, pSrc);
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		}
+
+		void ApplyTexture(uint32_t id) override
+		{
+			glBindTexture(GL_TEXTURE_2D, id);
+		}
+
+		void ClearBuffer(olc::Pixel p, bool bDepth) override
+		{
+			glClearColor(float(p.r) / 255.0f, float(p.g) / 255.0f, float(p.b) / 255.0f, float(p.a) / 255.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+			if (bDepth) glClear(GL_DEPTH_BUFFER_BIT);
+		}
+
+		void UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) override
+		{
+#if defined(__APPLE__)
+			if (!mFullScreen) glutReshapeWindow(size.x, size.y);
+#else
+			glViewport(pos.x, pos.y, size.x, size.y);
+#endif
+		}
+	};
+}
+#endif
+// O------------------------------------------------------------------------------O
+// | END RENDERER: OpenGL 1.0 (the original, the best...)                         |
 // O------------------------------------------------------------------------------O
 
+
 // O------------------------------------------------------------------------------O
-// | START RENDERER: OpenGL 1.0 (the original, the best...)                       |
+// | START RENDERER: OpenGL 3.3 (core profile, shaders & instanced quads)         |
 // O------------------------------------------------------------------------------O
-#if defined(OLC_GFX_OPENGL10)
+#if defined(OLC_GFX_OPENGL33)
+// Shares the platform headers and types of the OpenGL 1.0 renderer, which is
+// always compiled alongside, everything beyond GL 1.1 is loaded at runtime
+#if !defined(CALLSTYLE)
 	#if defined(_WIN32)
-	#include <windows.h>
-	#include <dwmapi.h>
-	#include <GL/gl.h>
-	#pragma comment(lib, "Dwmapi.lib")
-	typedef BOOL(WINAPI wglSwapInterval_t) (int interval);
-	static wglSwapInterval_t* wglSwapInterval = nullptr;
-	typedef HDC glDeviceContext_t;
-	typedef HGLRC glRenderContext_t;
+		#define CALLSTYLE __stdcall
+	#else
+		#define CALLSTYLE
+	#endif
 #endif
 
-#if defined(__linux__) || defined(__FreeBSD__)
-	#include <GL/gl.h>
-	namespace X11
-	{
-		#include <GL/glx.h>
-		#include <X11/X.h>
-		#include <X11/Xlib.h>
-	}
-
-	typedef int(glSwapInterval_t)(X11::Display* dpy, X11::GLXDrawable drawable, int interval);
-	static glSwapInterval_t* glSwapIntervalEXT;
-	typedef X11::GLXContext glDeviceContext_t;
-	typedef X11::GLXContext glRenderContext_t;
+#if defined(_WIN32)
+	typedef HGLRC(WINAPI locCreateContextAttribs_t)(HDC hdc, HGLRC share, const int* attribs);
+	#define OGL_LOAD(t, n) (t*)wglGetProcAddress(#n)
+#elif defined(OLC_PLATFORM_HEADLESS)
+	#define OGL_LOAD(t, n) (t*)eglGetProcAddress(#n)
+#else
+	typedef X11::GLXContext locCreateContextAttribs_t(X11::Display* dpy, X11::GLXFBConfig config, X11::GLXContext share, int direct, const int* attribs);
+	#define OGL_LOAD(t, n) (t*)X11::glXGetProcAddress((const unsigned char*)#n)
 #endif
 
-#if defined(__APPLE__)
-	#define GL_SILENCE_DEPRECATION
-	#include <GLUT/glut.h>
-	#include <OpenGL/OpenGL.h>
-	#include <OpenGL/gl.h>
-	#include <OpenGL/glu.h>
-#endif
+	typedef GLuint CALLSTYLE locCreateShader_t(GLenum type);
+	typedef void CALLSTYLE locShaderSource_t(GLuint shader, GLsizei count, const char* const* string, const GLint* length);
+	typedef void CALLSTYLE locCompileShader_t(GLuint shader);
+	typedef void CALLSTYLE locGetShaderiv_t(GLuint shader, GLenum pname, GLint* params);
+	typedef void CALLSTYLE locDeleteShader_t(GLuint shader);
+	typedef GLuint CALLSTYLE locCreateProgram_t();
+	typedef void CALLSTYLE locAttachShader_t(GLuint program, GLuint shader);
+	typedef void CALLSTYLE locLinkProgram_t(GLuint program);
+	typedef void CALLSTYLE locGetProgramiv_t(GLuint program, GLenum pname, GLint* params);
+	typedef void CALLSTYLE locUseProgram_t(GLuint program);
+	typedef void CALLSTYLE locDeleteProgram_t(GLuint program);
+	typedef void CALLSTYLE locGenVertexArrays_t(GLsizei n, GLuint* arrays);
+	typedef void CALLSTYLE locBindVertexArray_t(GLuint array);
+	typedef void CALLSTYLE locDeleteVertexArrays_t(GLsizei n, const GLuint* arrays);
+	typedef void CALLSTYLE locGenBuffers_t(GLsizei n, GLuint* buffers);
+	typedef void CALLSTYLE locDeleteBuffers_t(GLsizei n, const GLuint* buffers);
+	typedef void CALLSTYLE locBindBuffer_t(GLenum target, GLuint buffer);
+	typedef void CALLSTYLE locBufferData_t(GLenum target, ptrdiff_t size, const void* data, GLenum usage);
+	typedef void CALLSTYLE locBufferStorage_t(GLenum target, ptrdiff_t size, const void* data, GLbitfield flags);
+	typedef void* CALLSTYLE locMapBufferRange_t(GLenum target, ptrdiff_t offset, ptrdiff_t length, GLbitfield access);
+	typedef void CALLSTYLE locVertexAttribPointer_t(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+	typedef void CALLSTYLE locEnableVertexAttribArray_t(GLuint index);
+	typedef void CALLSTYLE locVertexAttribDivisor_t(GLuint index, GLuint divisor);
+	typedef void CALLSTYLE locDrawArraysInstanced_t(GLenum mode, GLint first, GLsizei count, GLsizei instancecount);
+	typedef const GLubyte* CALLSTYLE locGetStringi_t(GLenum name, GLuint index);
+	typedef void* CALLSTYLE locFenceSync_t(GLenum condition, GLbitfield flags);
+	typedef GLenum CALLSTYLE locClientWaitSync_t(void* sync, GLbitfield flags, uint64_t timeout);
+	typedef void CALLSTYLE locDeleteSync_t(void* sync);
 
 namespace olc
 {
-	class Renderer_OGL10 : public olc::Renderer
+	class Renderer_OGL33 : public olc::Renderer
 	{
 	private:
-#if defined(__APPLE__)
-		bool mFullScreen = false;
-#else
 		glDeviceContext_t glDeviceContext = 0;
 		glRenderContext_t glRenderContext = 0;
-#endif
 
 		bool bSync = false;
 
-#if defined(__linux__) || defined(__FreeBSD__)
+		static constexpr GLenum VERTEX_SHADER = 0x8B31;
+		static constexpr GLenum FRAGMENT_SHADER = 0x8B30;
+		static constexpr GLenum COMPILE_STATUS = 0x8B81;
+		static constexpr GLenum LINK_STATUS = 0x8B82;
+		static constexpr GLenum ARRAY_BUFFER = 0x8892;
+		static constexpr GLenum STREAM_DRAW = 0x88E0;
+		static constexpr GLbitfield MAP_WRITE_BIT = 0x0002;
+		static constexpr GLbitfield MAP_PERSISTENT_BIT = 0x0040;
+		static constexpr GLbitfield MAP_COHERENT_BIT = 0x0080;
+		static constexpr GLenum MAJOR_VERSION = 0x821B;
+		static constexpr GLenum MINOR_VERSION = 0x821C;
+		static constexpr GLenum NUM_EXTENSIONS = 0x821D;
+		static constexpr GLenum SYNC_GPU_COMMANDS_COMPLETE = 0x9117;
+		static constexpr GLbitfield SYNC_FLUSH_COMMANDS_BIT = 0x0001;
+		static constexpr GLenum CLAMP_TO_EDGE = 0x812F;
+
+		locCreateShader_t* locCreateShader = nullptr;
+		locShaderSource_t* locShaderSource = nullptr;
+		locCompileShader_t* locCompileShader = nullptr;
+		locGetShaderiv_t* locGetShaderiv = nullptr;
+		locDeleteShader_t* locDeleteShader = nullptr;
+		locCreateProgram_t* locCreateProgram = nullptr;
+		locAttachShader_t* locAttachShader = nullptr;
+		locLinkProgram_t* locLinkProgram = nullptr;
+		locGetProgramiv_t* locGetProgramiv = nullptr;
+		locUseProgram_t* locUseProgram = nullptr;
+		locDeleteProgram_t* locDeleteProgram = nullptr;
+		locGenVertexArrays_t* locGenVertexArrays = nullptr;
+		locBindVertexArray_t* locBindVertexArray = nullptr;
+		locDeleteVertexArrays_t* locDeleteVertexArrays = nullptr;
+		locGenBuffers_t* locGenBuffers = nullptr;
+		locDeleteBuffers_t* locDeleteBuffers = nullptr;
+		locBindBuffer_t* locBindBuffer = nullptr;
+		locBufferData_t* locBufferData = nullptr;
+		locBufferStorage_t* locBufferStorage = nullptr;
+		locMapBufferRange_t* locMapBufferRange = nullptr;
+		locVertexAttribPointer_t* locVertexAttribPointer = nullptr;
+		locEnableVertexAttribArray_t* locEnableVertexAttribArray = nullptr;
+		locVertexAttribDivisor_t* locVertexAttribDivisor = nullptr;
+		locDrawArraysInstanced_t* locDrawArraysInstanced = nullptr;
+		locGetStringi_t* locGetStringi = nullptr;
+		locFenceSync_t* locFenceSync = nullptr;
+		locClientWaitSync_t* locClientWaitSync = nullptr;
+		locDeleteSync_t* locDeleteSync = nullptr;
+
+		GLuint nProgram = 0;
+		GLuint nVAO = 0;
+		GLuint nVB = 0;
+		GLuint nBlankTexture = 0;
+		uint32_t nActiveTexture = 0;
+		std::vector<uint32_t> vecQuadTexture;
+
+		// Size of the storage allocated for each texture, so uploads of the
+		// same size only replace contents and never reallocate
+		std::map<uint32_t, olc::vi2d> mapTextureSize;
+
+		// Every quad, layer or decal, is one instance of a 4 vertex triangle
+		// strip, and the vertex shader picks its corner from the instance
+		struct locInstance { float pos[8]; float tex[8]; float w[4]; olc::Pixel col[4]; };
+
+		// With persistent mapping the instance buffer holds one region per
+		// frame in flight, each guarded by a fence, and is written in place.
+		// Otherwise instances are staged here and the buffer is respecified
+		static constexpr size_t nFramesInFlight = 3;
+		locInstance* pInstanceMap = nullptr;
+		size_t nInstanceCapacity = 0;
+		size_t nInstanceCursor = 0;
+		size_t nFrame = 0;
+		void* pFrameFence[nFramesInFlight] = { nullptr, nullptr, nullptr };
+		std::vector<locInstance> vecInstances;
+
+#if (defined(__linux__) || defined(__FreeBSD__)) && !defined(OLC_PLATFORM_HEADLESS)
 		X11::Display* olc_Display = nullptr;
 		X11::Window* olc_Window = nullptr;
 		X11::XVisualInfo* olc_VisualInfo = nullptr;
 #endif
 
-	public:
-		void PrepareDevice() override
-		{ 
-#if defined(__APPLE__)
-			//glutInit has to be called with main() arguments, make fake ones
-			int argc = 0;
-			char* argv[1] = { (char*)"" };
-			glutInit(&argc, argv);
-
-			glutInitWindowPosition(0, 0);
-			glutInitWindowSize(512, 512);
-
-			glutInitDisplayMode(GLUT_DOUBLE | GLUT_DEPTH | GLUT_RGBA);
+#if defined(OLC_PLATFORM_HEADLESS)
+		olc::HeadlessGLContext glHeadless;
+#endif
 
-			// Creates the window and the OpenGL context for it
-			glutCreateWindow("OneLoneCoder.com - Pixel Game Engine");
+		const char* sVertexShader =
+			"#version 330 core\n"
+			"layout(location = 0) in vec4 aPos01; layout(location = 1) in vec4 aPos23;\n"
+			"layout(location = 2) in vec4 aTex01; layout(location = 3) in vec4 aTex23;\n"
+			"layout(location = 4) in vec4 aW;\n"
+			"layout(location = 5) in vec4 aCol0; layout(location = 6) in vec4 aCol1;\n"
+			"layout(location = 7) in vec4 aCol2; layout(location = 8) in vec4 aCol3;\n"
+			"out vec3 oTex; out vec4 oCol;\n"
+			"void main()\n"
+			"{\n"
+			// Strip order 1,0,2,3 splits the quad along 0-2, as GL_QUADS does
+			"	int c = int[4](1, 0, 2, 3)[gl_VertexID];\n"
+			"	vec2 p[4] = vec2[4](aPos01.xy, aPos01.zw, aPos23.xy, aPos23.zw);\n"
+			"	vec2 t[4] = vec2[4](aTex01.xy, aTex01.zw, aTex23.xy, aTex23.zw);\n"
+			"	vec4 k[4] = vec4[4](aCol0, aCol1, aCol2, aCol3);\n"
+			"	gl_Position = vec4(p[c], 0.0, 1.0);\n"
+			"	oTex = vec3(t[c], aW[c]);\n"
+			"	oCol = k[c];\n"
+			"}\n";
+
+		const char* sFragmentShader =
+			"#version 330 core\n"
+			"in vec3 oTex; in vec4 oCol;\n"
+			"out vec4 pixel;\n"
+			"uniform sampler2D sprTex;\n"
+			"void main()\n"
+			"{\n"
+			"	pixel = textureProj(sprTex, oTex) * oCol;\n"
+			"}\n";
 
-			glEnable(GL_TEXTURE_2D); // Turn on texturing
-			glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
-#endif
-		}
+	public:
+		void PrepareDevice() override
+		{}
 
 		olc::rcode CreateDevice(std::vector<void*> params, bool bFullScreen, bool bVSYNC) override
 		{
+			UNUSED(bFullScreen);
+			// Core profile contexts are only handed out by the ARB extension
+			const int nContextAttribs[] =
+			{
+				0x2091, 3,		// CONTEXT_MAJOR_VERSION_ARB
+				0x2092, 3,		// CONTEXT_MINOR_VERSION_ARB
+				0x9126, 0x0001,	// CONTEXT_PROFILE_MASK_ARB, CONTEXT_CORE_PROFILE_BIT_ARB
+				0
+			};
+
 #if defined(_WIN32)
-			// Create Device Context
 			glDeviceContext = GetDC((HWND)(params[0]));
 			PIXELFORMATDESCRIPTOR pfd =
 			{
@@ -2805,194 +5915,659 @@ namespace olc
 			if (!(pf = ChoosePixelFormat(glDeviceContext, &pfd))) return olc::FAIL;
 			SetPixelFormat(glDeviceContext, pf, &pfd);
 
-			if (!(glRenderContext = wglCreateContext(glDeviceContext))) return olc::FAIL;
+			// A legacy context has to be current to find the function that
+			// creates the real one
+			HGLRC glLegacyContext = wglCreateContext(glDeviceContext);
+			if (!glLegacyContext) return olc::FAIL;
+			wglMakeCurrent(glDeviceContext, glLegacyContext);
+			locCreateContextAttribs_t* locCreateContextAttribs = OGL_LOAD(locCreateContextAttribs_t, wglCreateContextAttribsARB);
+			if (locCreateContextAttribs) glRenderContext = locCreateContextAttribs(glDeviceContext, nullptr, nContextAttribs);
+			wglMakeCurrent(glDeviceContext, nullptr);
+			wglDeleteContext(glLegacyContext);
+			if (!glRenderContext) return olc::FAIL;
 			wglMakeCurrent(glDeviceContext, glRenderContext);
 
-			// Remove Frame cap
 			wglSwapInterval = (wglSwapInterval_t*)wglGetProcAddress("wglSwapIntervalEXT");
 			if (wglSwapInterval && !bVSYNC) wglSwapInterval(0);
 			bSync = bVSYNC;
 #endif
 
-#if defined(__linux__) || defined(__FreeBSD__)
-			using namespace X11;
-			// Linux has tighter coupling between OpenGL and X11, so we store
-			// various "platform" handles in the renderer
-			olc_Display = (X11::Display*)(params[0]);
-			olc_Window = (X11::Window*)(params[1]);
-			olc_VisualInfo = (X11::XVisualInfo*)(params[2]);
+#if defined(OLC_PLATFORM_HEADLESS)
+			UNUSED(params); UNUSED(nContextAttribs);
+			if (glHeadless.Create(true, ptrPGE->GetWindowSize()) != olc::OK) return olc::FAIL;
+			bSync = bVSYNC;
+#endif
+
+#if (defined(__linux__) || defined(__FreeBSD__)) && !defined(OLC_PLATFORM_HEADLESS)
+			using namespace X11;
+			olc_Display = (X11::Display*)(params[0]);
+			olc_Window = (X11::Window*)(params[1]);
+			olc_VisualInfo = (X11::XVisualInfo*)(params[2]);
+
+			// The context is created from a framebuffer config, use the one
+			// behind the visual the window was created with
+			int nConfigs = 0;
+			GLXFBConfig* pConfigs = glXGetFBConfigs(olc_Display, olc_VisualInfo->screen, &nConfigs);
+			GLXFBConfig fbConfig = nullptr;
+			for (int i = 0; i < nConfigs && fbConfig == nullptr; i++)
+			{
+				int nVisualID = 0;
+				glXGetFBConfigAttrib(olc_Display, pConfigs[i], GLX_VISUAL_ID, &nVisualID);
+				if (X11::VisualID(nVisualID) == olc_VisualInfo->visualid) fbConfig = pConfigs[i];
+			}
+			if (pConfigs) XFree(pConfigs);
+
+			locCreateContextAttribs_t* locCreateContextAttribs = OGL_LOAD(locCreateContextAttribs_t, glXCreateContextAttribsARB);
+			if (fbConfig == nullptr || locCreateContextAttribs == nullptr) return olc::FAIL;
+			glDeviceContext = locCreateContextAttribs(olc_Display, fbConfig, nullptr, True, nContextAttribs);
+			if (glDeviceContext == nullptr) return olc::FAIL;
+			glXMakeCurrent(olc_Display, *olc_Window, glDeviceContext);
+
+			XWindowAttributes gwa;
+			XGetWindowAttributes(olc_Display, *olc_Window, &gwa);
+			glViewport(0, 0, gwa.width, gwa.height);
+
+			glSwapIntervalEXT = (glSwapInterval_t*)glXGetProcAddress((unsigned char*)"glXSwapIntervalEXT");
+			if (glSwapIntervalEXT != nullptr && !bVSYNC)
+				glSwapIntervalEXT(olc_Display, *olc_Window, 0);
+#endif
+
+			locCreateShader = OGL_LOAD(locCreateShader_t, glCreateShader);
+			locShaderSource = OGL_LOAD(locShaderSource_t, glShaderSource);
+			locCompileShader = OGL_LOAD(locCompileShader_t, glCompileShader);
+			locGetShaderiv = OGL_LOAD(locGetShaderiv_t, glGetShaderiv);
+			locDeleteShader = OGL_LOAD(locDeleteShader_t, glDeleteShader);
+			locCreateProgram = OGL_LOAD(locCreateProgram_t, glCreateProgram);
+			locAttachShader = OGL_LOAD(locAttachShader_t, glAttachShader);
+			locLinkProgram = OGL_LOAD(locLinkProgram_t, glLinkProgram);
+			locGetProgramiv = OGL_LOAD(locGetProgramiv_t, glGetProgramiv);
+			locUseProgram = OGL_LOAD(locUseProgram_t, glUseProgram);
+			locDeleteProgram = OGL_LOAD(locDeleteProgram_t, glDeleteProgram);
+			locGenVertexArrays = OGL_LOAD(locGenVertexArrays_t, glGenVertexArrays);
+			locBindVertexArray = OGL_LOAD(locBindVertexArray_t, glBindVertexArray);
+			locDeleteVertexArrays = OGL_LOAD(locDeleteVertexArrays_t, glDeleteVertexArrays);
+			locGenBuffers = OGL_LOAD(locGenBuffers_t, glGenBuffers);
+			locDeleteBuffers = OGL_LOAD(locDeleteBuffers_t, glDeleteBuffers);
+			locBindBuffer = OGL_LOAD(locBindBuffer_t, glBindBuffer);
+			locBufferData = OGL_LOAD(locBufferData_t, glBufferData);
+			locBufferStorage = OGL_LOAD(locBufferStorage_t, glBufferStorage);
+			locMapBufferRange = OGL_LOAD(locMapBufferRange_t, glMapBufferRange);
+			locVertexAttribPointer = OGL_LOAD(locVertexAttribPointer_t, glVertexAttribPointer);
+			locEnableVertexAttribArray = OGL_LOAD(locEnableVertexAttribArray_t, glEnableVertexAttribArray);
+			locVertexAttribDivisor = OGL_LOAD(locVertexAttribDivisor_t, glVertexAttribDivisor);
+			locDrawArraysInstanced = OGL_LOAD(locDrawArraysInstanced_t, glDrawArraysInstanced);
+			locGetStringi = OGL_LOAD(locGetStringi_t, glGetStringi);
+			locFenceSync = OGL_LOAD(locFenceSync_t, glFenceSync);
+			locClientWaitSync = OGL_LOAD(locClientWaitSync_t, glClientWaitSync);
+			locDeleteSync = OGL_LOAD(locDeleteSync_t, glDeleteSync);
+
+			// Compile the shader pair
+			GLuint nVS = CompileShader(VERTEX_SHADER, sVertexShader);
+			GLuint nFS = CompileShader(FRAGMENT_SHADER, sFragmentShader);
+			GLint nLinked = 0;
+			if (nVS != 0 && nFS != 0)
+			{
+				nProgram = locCreateProgram();
+				locAttachShader(nProgram, nVS);
+				locAttachShader(nProgram, nFS);
+				locLinkProgram(nProgram);
+				locGetProgramiv(nProgram, LINK_STATUS, &nLinked);
+			}
+			if (nVS != 0) locDeleteShader(nVS);
+			if (nFS != 0) locDeleteShader(nFS);
+			if (!nLinked) return olc::FAIL;
+
+			// All instance attributes advance once per quad
+			locGenVertexArrays(1, &nVAO);
+			locBindVertexArray(nVAO);
+			for (GLuint i = 0; i < 9; i++)
+			{
+				locEnableVertexAttribArray(i);
+				locVertexAttribDivisor(i, 1);
+			}
+
+			// Buffer storage is core from 4.4, but llvmpipe and most drivers
+			// expose it to 3.3 contexts too, so check for either
+			GLint nMajor = 0, nMinor = 0, nExtensions = 0;
+			glGetIntegerv(MAJOR_VERSION, &nMajor);
+			glGetIntegerv(MINOR_VERSION, &nMinor);
+			bool bBufferStorage = nMajor * 10 + nMinor >= 44;
+			glGetIntegerv(NUM_EXTENSIONS, &nExtensions);
+			for (GLint i = 0; i < nExtensions && !bBufferStorage; i++)
+				bBufferStorage = std::strcmp((const char*)locGetStringi(GL_EXTENSIONS, i), "GL_ARB_buffer_storage") == 0;
+			CreateInstanceBuffer(1024, bBufferStorage && locBufferStorage && locMapBufferRange && locFenceSync);
+
+			// Untextured decals sample a single white texel
+			nBlankTexture = CreateTexture(1, 1);
+			const olc::Pixel pWhite = olc::WHITE;
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, &pWhite);
+			return olc::rcode::OK;
+		}
+
+		olc::rcode DestroyDevice() override
+		{
+			for (auto& fence : pFrameFence)
+				if (fence != nullptr) { locDeleteSync(fence); fence = nullptr; }
+			if (nVB != 0) locDeleteBuffers(1, &nVB);
+			if (nVAO != 0) locDeleteVertexArrays(1, &nVAO);
+			if (nProgram != 0) locDeleteProgram(nProgram);
+			if (nBlankTexture != 0) DeleteTexture(nBlankTexture);
+			nVB = nVAO = nProgram = nBlankTexture = 0;
+			pInstanceMap = nullptr;
+
+#if defined(_WIN32)
+			wglMakeCurrent(glDeviceContext, nullptr);
+			wglDeleteContext(glRenderContext);
+#endif
+
+#if (defined(__linux__) || defined(__FreeBSD__)) && !defined(OLC_PLATFORM_HEADLESS)
+			glXMakeCurrent(olc_Display, None, NULL);
+			glXDestroyContext(olc_Display, glDeviceContext);
+#endif
+
+#if defined(OLC_PLATFORM_HEADLESS)
+			glHeadless.Destroy();
+#endif
+			return olc::rcode::OK;
+		}
+
+		void DisplayFrame() override
+		{
+			// Fence the instances of this frame, so their region is not
+			// overwritten before the GPU has finished reading it
+			if (pInstanceMap != nullptr)
+				pFrameFence[nFrame % nFramesInFlight] = locFenceSync(SYNC_GPU_COMMANDS_COMPLETE, 0);
+			nFrame++;
+
+#if defined(_WIN32)
+			SwapBuffers(glDeviceContext);
+			if (bSync) DwmFlush();
+#endif
+
+#if (defined(__linux__) || defined(__FreeBSD__)) && !defined(OLC_PLATFORM_HEADLESS)
+			X11::glXSwapBuffers(olc_Display, *olc_Window);
+#endif
+
+#if defined(OLC_PLATFORM_HEADLESS)
+			glFinish();
+#endif
+		}
+
+#if defined(OLC_PLATFORM_HEADLESS)
+		const olc::Sprite* GetFrame() override
+		{
+			return glHeadless.ReadFrame();
+		}
+#endif
+
+		void PrepareDrawing() override
+		{
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			locUseProgram(nProgram);
+			locBindVertexArray(nVAO);
+			locBindBuffer(ARRAY_BUFFER, nVB);
+
+			void*& fence = pFrameFence[nFrame % nFramesInFlight];
+			if (fence != nullptr)
+			{
+				locClientWaitSync(fence, SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+				locDeleteSync(fence);
+				fence = nullptr;
+			}
+			nInstanceCursor = 0;
+		}
+
+		void DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) override
+		{
+			locInstance* q = MapInstances(1);
+			const float x0 = offset.x, y0 = offset.y, x1 = scale.x + offset.x, y1 = scale.y + offset.y;
+			*q = {
+				{ -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f },
+				{ x0, y0, x0, y1, x1, y1, x1, y0 },
+				{ 1.0f, 1.0f, 1.0f, 1.0f },
+				{ tint, tint, tint, tint } };
+			DrawInstances(CommitInstances(1), 0, 1, nActiveTexture);
+		}
+
+		// As with OpenGL 1.0, untextured decals are shaded per vertex and
+		// textured ones by their first tint only
+		void PackInstance(locInstance& q, const olc::DecalInstance& decal)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				q.pos[i * 2 + 0] = decal.pos[i].x; q.pos[i * 2 + 1] = decal.pos[i].y;
+				q.tex[i * 2 + 0] = decal.uv[i].x; q.tex[i * 2 + 1] = decal.uv[i].y;
+				q.w[i] = decal.w[i];
+				q.col[i] = decal.decal == nullptr ? decal.tint[i] : decal.tint[0];
+			}
+		}
+
+		void DrawDecalQuad(const olc::DecalInstance& decal) override
+		{
+			PackInstance(*MapInstances(1), decal);
+			DrawInstances(CommitInstances(1), 0, 1, decal.decal == nullptr ? nBlankTexture : decal.decal->id);
+		}
+
+		void DrawDecalQuads(const olc::LayerDesc& layer) override
+		{
+			const size_t nQuads = olc::DecalCount(layer);
+			if (nQuads == 0) return;
+
+			locInstance* q = MapInstances(nQuads);
+			vecQuadTexture.resize(nQuads);
+			uint32_t* t = vecQuadTexture.data();
+			olc::ForEachDecal(layer, [&](const olc::DecalInstance& decal)
+			{
+				PackInstance(*q++, decal);
+				*t++ = decal.decal == nullptr ? nBlankTexture : decal.decal->id;
+			});
+			const size_t nOffset = CommitInstances(nQuads);
+
+			// One instanced draw per run of the same texture, keeping draw order
+			size_t nRunStart = 0;
+			for (size_t i = 1; i <= nQuads; i++)
+			{
+				const uint32_t nRunTexture = vecQuadTexture[nRunStart];
+				if (i < nQuads && vecQuadTexture[i] == nRunTexture)
+					continue;
+
+				DrawInstances(nOffset, nRunStart, i - nRunStart, nRunTexture);
+				nRunStart = i;
+			}
+		}
+
+		uint32_t CreateTexture(const uint32_t width, const uint32_t height) override
+		{
+			uint32_t id = 0;
+			glGenTextures(1, &id);
+			glBindTexture(GL_TEXTURE_2D, id);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, CLAMP_TO_EDGE);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			mapTextureSize[id] = { int32_t(width), int32_t(height) };
+			nActiveTexture = id;
+			return id;
+		}
+
+		uint32_t DeleteTexture(const uint32_t id) override
+		{
+			glDeleteTextures(1, &id);
+			mapTextureSize.erase(id);
+			return id;
+		}
+
+		void UpdateTexture(uint32_t id, olc::Sprite* spr) override
+		{
+			UpdateTextureRegion(id, spr, { 0, 0 }, { spr->width, spr->height });
+		}
+
+		void UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) override
+		{
+			olc::vi2d& vStorage = mapTextureSize[id];
+			if (vStorage.x != spr->width || vStorage.y != spr->height)
+			{
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, spr->width, spr->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
+				vStorage = { spr->width, spr->height };
+				return;
+			}
+
+			if (size.x <= 0 || size.y <= 0) return;
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, spr->width);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData() + pos.y * spr->width + pos.x);
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		}
+
+		void ApplyTexture(uint32_t id) override
+		{
+			glBindTexture(GL_TEXTURE_2D, id);
+			nActiveTexture = id;
+		}
+
+		void ClearBuffer(olc::Pixel p, bool bDepth) override
+		{
+			glClearColor(float(p.r) / 255.0f, float(p.g) / 255.0f, float(p.b) / 255.0f, float(p.a) / 255.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+			if (bDepth) glClear(GL_DEPTH_BUFFER_BIT);
+		}
+
+		void UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) override
+		{
+			glViewport(pos.x, pos.y, size.x, size.y);
+		}
+
+	private:
+		GLuint CompileShader(GLenum type, const char* sSource)
+		{
+			GLuint nShader = locCreateShader(type);
+			locShaderSource(nShader, 1, &sSource, nullptr);
+			locCompileShader(nShader);
+			GLint nCompiled = 0;
+			locGetShaderiv(nShader, COMPILE_STATUS, &nCompiled);
+			if (nCompiled) return nShader;
+			locDeleteShader(nShader);
+			return 0;
+		}
+
+		void CreateInstanceBuffer(size_t nCapacity, bool bPersistent)
+		{
+			if (nVB != 0) locDeleteBuffers(1, &nVB);
+			locGenBuffers(1, &nVB);
+			locBindBuffer(ARRAY_BUFFER, nVB);
+			nInstanceCapacity = nCapacity;
+			pInstanceMap = nullptr;
+			if (bPersistent)
+			{
+				const GLbitfield nFlags = MAP_WRITE_BIT | MAP_PERSISTENT_BIT | MAP_COHERENT_BIT;
+				const ptrdiff_t nSize = ptrdiff_t(nCapacity * nFramesInFlight * sizeof(locInstance));
+				locBufferStorage(ARRAY_BUFFER, nSize, nullptr, nFlags);
+				pInstanceMap = (locInstance*)locMapBufferRange(ARRAY_BUFFER, 0, nSize, nFlags);
+			}
+		}
+
+		// Returns where to write the next n instances of this frame
+		locInstance* MapInstances(size_t n)
+		{
+			if (pInstanceMap == nullptr)
+			{
+				vecInstances.resize(n);
+				return vecInstances.data();
+			}
+
+			if (nInstanceCursor + n > nInstanceCapacity)
+			{
+				// Out of room, wait for the GPU to go idle and start a larger buffer
+				glFinish();
+				for (auto& fence : pFrameFence)
+					if (fence != nullptr) { locDeleteSync(fence); fence = nullptr; }
+				CreateInstanceBuffer(std::max(nInstanceCapacity * 2, nInstanceCursor + n), true);
+			}
+			return pInstanceMap + (nFrame % nFramesInFlight) * nInstanceCapacity + nInstanceCursor;
+		}
+
+		// Hands the n instances just written to the GPU, returns their byte offset in the buffer
+		size_t CommitInstances(size_t n)
+		{
+			if (pInstanceMap == nullptr)
+			{
+				locBufferData(ARRAY_BUFFER, ptrdiff_t(n * sizeof(locInstance)), vecInstances.data(), STREAM_DRAW);
+				return 0;
+			}
+
+			const size_t nOffset = ((nFrame % nFramesInFlight) * nInstanceCapacity + nInstanceCursor) * sizeof(locInstance);
+			nInstanceCursor += n;
+			return nOffset;
+		}
+
+		void DrawInstances(size_t nOffset, size_t nFirst, size_t nCount, uint32_t nTexture)
+		{
+			const size_t nBase = nOffset + nFirst * sizeof(locInstance);
+			auto Attrib = [&](GLuint index, GLenum type, size_t nMember)
+			{
+				locVertexAttribPointer(index, 4, type, type == GL_UNSIGNED_BYTE, sizeof(locInstance), (const void*)(nBase + nMember));
+			};
+			Attrib(0, GL_FLOAT, offsetof(locInstance, pos));
+			Attrib(1, GL_FLOAT, offsetof(locInstance, pos) + 4 * sizeof(float));
+			Attrib(2, GL_FLOAT, offsetof(locInstance, tex));
+			Attrib(3, GL_FLOAT, offsetof(locInstance, tex) + 4 * sizeof(float));
+			Attrib(4, GL_FLOAT, offsetof(locInstance, w));
+			for (GLuint i = 0; i < 4; i++)
+				Attrib(5 + i, GL_UNSIGNED_BYTE, offsetof(locInstance, col) + i * sizeof(olc::Pixel));
+
+			glBindTexture(GL_TEXTURE_2D, nTexture);
+			locDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(nCount));
+		}
+	};
+}
+#endif
+// O------------------------------------------------------------------------------O
+// | END RENDERER: OpenGL 3.3 (core profile, shaders & instanced quads)           |
+// O------------------------------------------------------------------------------O
+
+
+// O------------------------------------------------------------------------------O
+// | START RENDERER: Software (offscreen, composites into an olc::Sprite)         |
+// O------------------------------------------------------------------------------O
+// Needs no device at all, so it is always available. It is the renderer of the
+// headless platform, and elsewhere can be chosen with GfxBackend::SOFTWARE, in
+// which case nothing reaches the window and frames are read via GetRenderedFrame()
+namespace olc
+{
+	class Renderer_Software : public olc::Renderer
+	{
+	private:
+		struct Texture
+		{
+			int32_t nWidth = 0, nHeight = 0;
+			std::vector<olc::Pixel> vecData;
+		};
+
+		struct Vertex
+		{
+			float x, y, u, v, w;
+			olc::Pixel col;
+		};
+
+		std::map<uint32_t, Texture> mapTextures;
+		uint32_t nNextTexture = 1;
+		uint32_t nActiveTexture = 0;
+		std::unique_ptr<olc::Sprite> sprFrame;
+		std::vector<olc::Pixel> vecRow;
+		std::vector<int32_t> vecColumn;
 
-			glDeviceContext = glXCreateContext(olc_Display, olc_VisualInfo, nullptr, GL_TRUE);
-			glXMakeCurrent(olc_Display, *olc_Window, glDeviceContext);
+		// Nearest sampling with clamped coordinates, as the OpenGL renderers do
+		static int32_t Texel(float f, int32_t n)
+		{
+			const int32_t i = int32_t(std::floor(f * float(n)));
+			return std::max(0, std::min(n - 1, i));
+		}
 
-			XWindowAttributes gwa;
-			XGetWindowAttributes(olc_Display, *olc_Window, &gwa);
-			glViewport(0, 0, gwa.width, gwa.height);
+		static olc::Pixel Modulate(olc::Pixel p, olc::Pixel tint)
+		{
+			if (tint == olc::WHITE) return p;
+			return olc::Pixel(uint8_t(span::Div255(p.r * tint.r)), uint8_t(span::Div255(p.g * tint.g)),
+				uint8_t(span::Div255(p.b * tint.b)), uint8_t(span::Div255(p.a * tint.a)));
+		}
 
-			glSwapIntervalEXT = nullptr;
-			glSwapIntervalEXT = (glSwapInterval_t*)glXGetProcAddress((unsigned char*)"glXSwapIntervalEXT");
+		// Edge function, always evaluated from the same end of the edge, so that two
+		// triangles sharing it agree exactly about which side a pixel centre is on
+		static float Edge(const Vertex& p, const Vertex& q, float x, float y)
+		{
+			if (p.y < q.y || (p.y == q.y && p.x < q.x))
+				return (q.x - p.x) * (y - p.y) - (q.y - p.y) * (x - p.x);
+			return -((p.x - q.x) * (y - q.y) - (p.y - q.y) * (x - q.x));
+		}
 
-			if (glSwapIntervalEXT == nullptr && !bVSYNC)
+		// Pixel centres exactly on an edge belong to only one of the triangles sharing it
+		static bool Inside(float e, const Vertex& p, const Vertex& q)
+		{
+			return e > 0.0f || (e == 0.0f && (q.y > p.y || (q.y == p.y && q.x < p.x)));
+		}
+
+		void RasterTriangle(const Vertex& a, Vertex b, Vertex c, const Texture* pTex, bool bShaded)
+		{
+			float fArea = Edge(a, b, c.x, c.y);
+			if (fArea == 0.0f) return;
+			if (fArea < 0.0f) { std::swap(b, c); fArea = -fArea; }
+			const float fInvArea = 1.0f / fArea;
+
+			const int32_t w = sprFrame->width, h = sprFrame->height;
+			const int32_t sx = std::max(0, int32_t(std::floor(std::min({ a.x, b.x, c.x }))));
+			const int32_t ex = std::min(w - 1, int32_t(std::ceil(std::max({ a.x, b.x, c.x }))));
+			const int32_t sy = std::max(0, int32_t(std::floor(std::min({ a.y, b.y, c.y }))));
+			const int32_t ey = std::min(h - 1, int32_t(std::ceil(std::max({ a.y, b.y, c.y }))));
+			if (sx > ex || sy > ey) return;
+
+			vecRow.resize(size_t(ex - sx + 1));
+			for (int32_t y = sy; y <= ey; y++)
 			{
-				printf("NOTE: Could not disable VSYNC, glXSwapIntervalEXT() was not found!\n");
-				printf("      Don't worry though, things will still work, it's just the\n");
-				printf("      frame rate will be capped to your monitors refresh rate - javidx9\n");
-			}
+				// Triangles are convex, so what is covered of a row is one run
+				int32_t nStart = -1, nCount = 0;
+				for (int32_t x = sx; x <= ex; x++)
+				{
+					const float px = float(x) + 0.5f, py = float(y) + 0.5f;
+					const float e0 = Edge(b, c, px, py), e1 = Edge(c, a, px, py), e2 = Edge(a, b, px, py);
+					if (!Inside(e0, b, c) || !Inside(e1, c, a) || !Inside(e2, a, b))
+					{
+						if (nCount > 0) break;
+						continue;
+					}
+					if (nStart < 0) nStart = x;
 
-			if (glSwapIntervalEXT != nullptr && !bVSYNC)
-				glSwapIntervalEXT(olc_Display, *olc_Window, 0);
-#endif		
+					const float l0 = e0 * fInvArea, l1 = e1 * fInvArea, l2 = e2 * fInvArea;
+					olc::Pixel col = a.col;
+					if (bShaded)
+					{
+						auto Lerp = [&](uint8_t c0, uint8_t c1, uint8_t c2)
+						{ return uint8_t(std::max(0.0f, std::min(255.0f, l0 * c0 + l1 * c1 + l2 * c2 + 0.5f))); };
+						col = olc::Pixel(Lerp(a.col.r, b.col.r, c.col.r), Lerp(a.col.g, b.col.g, c.col.g),
+							Lerp(a.col.b, b.col.b, c.col.b), Lerp(a.col.a, b.col.a, c.col.a));
+					}
 
-#if defined(__APPLE__)
-			mFullScreen = bFullScreen;
-			if (!bVSYNC)
-			{
-				GLint sync = 0;
-				CGLContextObj ctx = CGLGetCurrentContext();
-				if (ctx) CGLSetParameter(ctx, kCGLCPSwapInterval, &sync);
+					if (pTex != nullptr)
+					{
+						// Texture coordinates come multiplied by w, as for glTexCoord4f()
+						const float q = l0 * a.w + l1 * b.w + l2 * c.w;
+						const int32_t tx = Texel((l0 * a.u + l1 * b.u + l2 * c.u) / q, pTex->nWidth);
+						const int32_t ty = Texel((l0 * a.v + l1 * b.v + l2 * c.v) / q, pTex->nHeight);
+						col = Modulate(pTex->vecData[size_t(ty) * pTex->nWidth + tx], col);
+					}
+					vecRow[nCount++] = col;
+				}
+				if (nCount > 0)
+					span::Blend(sprFrame->GetData() + y * w + nStart, vecRow.data(), nCount, 1.0f);
 			}
-#else
-			glEnable(GL_TEXTURE_2D); // Turn on texturing
-			glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
-#endif
-			return olc::rcode::OK;
 		}
 
-		olc::rcode DestroyDevice() override
-		{
-#if defined(_WIN32)
-			wglDeleteContext(glRenderContext);
-#endif
+	public:
+		// The frame as it was last composited, it remains after the device is destroyed
+		const olc::Sprite* GetFrame() override
+		{ return sprFrame.get(); }
 
-#if defined(__linux__) || defined(__FreeBSD__)
-			glXMakeCurrent(olc_Display, None, NULL);
-			glXDestroyContext(olc_Display, glDeviceContext);
-#endif
+		void PrepareDevice() override
+		{ }
 
-#if defined(__APPLE__)
-			glutDestroyWindow(glutGetWindow());
-#endif
+		olc::rcode CreateDevice(std::vector<void*> params, bool bFullScreen, bool bVSYNC) override
+		{
+			UNUSED(params); UNUSED(bFullScreen); UNUSED(bVSYNC);
+			sprFrame = std::make_unique<olc::Sprite>(1, 1);
 			return olc::rcode::OK;
 		}
 
-		void DisplayFrame() override
+		olc::rcode DestroyDevice() override
 		{
-#if defined(_WIN32)
-			SwapBuffers(glDeviceContext);
-			if (bSync) DwmFlush(); // Woooohooooooo!!!! SMOOOOOOOTH!
-#endif	
-
-#if defined(__linux__) || defined(__FreeBSD__)
-			X11::glXSwapBuffers(olc_Display, *olc_Window);
-#endif		
-
-#if defined(__APPLE__)
-			glutSwapBuffers();
-#endif
+			mapTextures.clear();
+			return olc::rcode::OK;
 		}
 
+		void DisplayFrame() override
+		{ }
+
 		void PrepareDrawing() override
-		{
-			glEnable(GL_BLEND);
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		}
+		{ }
 
 		void DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) override
 		{
-			glBegin(GL_QUADS);
-			glColor4ub(tint.r, tint.g, tint.b, tint.a);
-			glTexCoord2f(0.0f * scale.x + offset.x, 1.0f * scale.y + offset.y);
-			glVertex3f(-1.0f /*+ vSubPixelOffset.x*/, -1.0f /*+ vSubPixelOffset.y*/, 0.0f);
-			glTexCoord2f(0.0f * scale.x + offset.x, 0.0f * scale.y + offset.y);
-			glVertex3f(-1.0f /*+ vSubPixelOffset.x*/, 1.0f /*+ vSubPixelOffset.y*/, 0.0f);
-			glTexCoord2f(1.0f * scale.x + offset.x, 0.0f * scale.y + offset.y);
-			glVertex3f(1.0f /*+ vSubPixelOffset.x*/, 1.0f /*+ vSubPixelOffset.y*/, 0.0f);
-			glTexCoord2f(1.0f * scale.x + offset.x, 1.0f * scale.y + offset.y);
-			glVertex3f(1.0f /*+ vSubPixelOffset.x*/, -1.0f /*+ vSubPixelOffset.y*/, 0.0f);
-			glEnd();
+			auto it = mapTextures.find(nActiveTexture);
+			if (it == mapTextures.end() || it->second.vecData.empty()) return;
+			const Texture& tex = it->second;
+			const int32_t w = sprFrame->width, h = sprFrame->height;
+
+			// The layer covers the whole viewport, so the source column of each
+			// frame column is the same on every row
+			vecColumn.resize(w);
+			for (int32_t x = 0; x < w; x++)
+				vecColumn[x] = Texel((float(x) + 0.5f) / float(w) * scale.x + offset.x, tex.nWidth);
+
+			vecRow.resize(w);
+			for (int32_t y = 0; y < h; y++)
+			{
+				const int32_t ty = Texel((float(y) + 0.5f) / float(h) * scale.y + offset.y, tex.nHeight);
+				const olc::Pixel* pSrc = tex.vecData.data() + size_t(ty) * tex.nWidth;
+				for (int32_t x = 0; x < w; x++) vecRow[x] = Modulate(pSrc[vecColumn[x]], tint);
+				span::Blend(sprFrame->GetData() + y * w, vecRow.data(), w, 1.0f);
+			}
 		}
 
 		void DrawDecalQuad(const olc::DecalInstance& decal) override
 		{
-			if (decal.decal == nullptr)
+			const Texture* pTex = nullptr;
+			if (decal.decal != nullptr)
 			{
-				glBindTexture(GL_TEXTURE_2D, 0);
-				glBegin(GL_QUADS);
-				glColor4ub(decal.tint[0].r, decal.tint[0].g, decal.tint[0].b, decal.tint[0].a);
-				glTexCoord4f(decal.uv[0].x, decal.uv[0].y, 0.0f, decal.w[0]); glVertex2f(decal.pos[0].x, decal.pos[0].y);
-				glColor4ub(decal.tint[1].r, decal.tint[1].g, decal.tint[1].b, decal.tint[1].a);
-				glTexCoord4f(decal.uv[1].x, decal.uv[1].y, 0.0f, decal.w[1]); glVertex2f(decal.pos[1].x, decal.pos[1].y);
-				glColor4ub(decal.tint[2].r, decal.tint[2].g, decal.tint[2].b, decal.tint[2].a);
-				glTexCoord4f(decal.uv[2].x, decal.uv[2].y, 0.0f, decal.w[2]); glVertex2f(decal.pos[2].x, decal.pos[2].y);
-				glColor4ub(decal.tint[3].r, decal.tint[3].g, decal.tint[3].b, decal.tint[3].a);
-				glTexCoord4f(decal.uv[3].x, decal.uv[3].y, 0.0f, decal.w[3]); glVertex2f(decal.pos[3].x, decal.pos[3].y);
-				glEnd();
+				auto it = mapTextures.find(decal.decal->id);
+				if (it == mapTextures.end() || it->second.vecData.empty()) return;
+				pTex = &it->second;
 			}
-			else
+
+			// Untextured decals are shaded per vertex, textured ones by their first
+			// tint only, the quad is split along the same diagonal as GL_QUADS
+			const float w = float(sprFrame->width), h = float(sprFrame->height);
+			Vertex v[4];
+			for (int i = 0; i < 4; i++)
 			{
-				glBindTexture(GL_TEXTURE_2D, decal.decal->id);
-				glBegin(GL_QUADS);
-				glColor4ub(decal.tint[0].r, decal.tint[0].g, decal.tint[0].b, decal.tint[0].a);
-				glTexCoord4f(decal.uv[0].x, decal.uv[0].y, 0.0f, decal.w[0]); glVertex2f(decal.pos[0].x, decal.pos[0].y);
-				glTexCoord4f(decal.uv[1].x, decal.uv[1].y, 0.0f, decal.w[1]); glVertex2f(decal.pos[1].x, decal.pos[1].y);
-				glTexCoord4f(decal.uv[2].x, decal.uv[2].y, 0.0f, decal.w[2]); glVertex2f(decal.pos[2].x, decal.pos[2].y);
-				glTexCoord4f(decal.uv[3].x, decal.uv[3].y, 0.0f, decal.w[3]); glVertex2f(decal.pos[3].x, decal.pos[3].y);
-				glEnd();
+				v[i].x = (decal.pos[i].x + 1.0f) * 0.5f * w;
+				v[i].y = (1.0f - decal.pos[i].y) * 0.5f * h;
+				v[i].u = decal.uv[i].x; v[i].v = decal.uv[i].y; v[i].w = decal.w[i];
+				v[i].col = pTex == nullptr ? decal.tint[i] : decal.tint[0];
 			}
+			RasterTriangle(v[0], v[1], v[2], pTex, pTex == nullptr);
+			RasterTriangle(v[0], v[2], v[3], pTex, pTex == nullptr);
 		}
 
 		uint32_t CreateTexture(const uint32_t width, const uint32_t height) override
 		{
-			UNUSED(width);
-			UNUSED(height);
-			uint32_t id = 0;
-			glGenTextures(1, &id);
-			glBindTexture(GL_TEXTURE_2D, id);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-			glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-			return id;
+			UNUSED(width); UNUSED(height);
+			nActiveTexture = nNextTexture++;
+			mapTextures[nActiveTexture] = Texture();
+			return nActiveTexture;
 		}
 
-		uint32_t DeleteTexture(const uint32_t id) override
+		void UpdateTexture(uint32_t id, olc::Sprite* spr) override
 		{
-			glDeleteTextures(1, &id);
-			return id;
+			Texture& tex = mapTextures[id];
+			tex.nWidth = spr->width; tex.nHeight = spr->height;
+			tex.vecData.assign(spr->GetData(), spr->GetData() + size_t(spr->width) * spr->height);
 		}
 
-		void UpdateTexture(uint32_t id, olc::Sprite* spr) override
+		void UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) override
 		{
-			UNUSED(id);
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, spr->width, spr->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
+			Texture& tex = mapTextures[id];
+			if (tex.nWidth != spr->width || tex.nHeight != spr->height) { UpdateTexture(id, spr); return; }
+			for (int32_t y = pos.y; y < pos.y + size.y; y++)
+			{
+				const olc::Pixel* pSrc = spr->GetData() + size_t(y) * spr->width + pos.x;
+				std::copy(pSrc, pSrc + size.x, tex.vecData.begin() + size_t(y) * tex.nWidth + pos.x);
+			}
 		}
 
-		void ApplyTexture(uint32_t id) override
+		uint32_t DeleteTexture(const uint32_t id) override
 		{
-			glBindTexture(GL_TEXTURE_2D, id);
+			mapTextures.erase(id);
+			return id;
 		}
 
-		void ClearBuffer(olc::Pixel p, bool bDepth) override
+		void ApplyTexture(uint32_t id) override
+		{ nActiveTexture = id; }
+
+		void UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) override
 		{
-			glClearColor(float(p.r) / 255.0f, float(p.g) / 255.0f, float(p.b) / 255.0f, float(p.a) / 255.0f);
-			glClear(GL_COLOR_BUFFER_BIT);
-			if (bDepth) glClear(GL_DEPTH_BUFFER_BIT);
+			UNUSED(pos);
+			const olc::vi2d vSize = { std::max(size.x, 1), std::max(size.y, 1) };
+			if (sprFrame == nullptr || sprFrame->width != vSize.x || sprFrame->height != vSize.y)
+				sprFrame = std::make_unique<olc::Sprite>(vSize.x, vSize.y);
 		}
 
-		void UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) override
+		void ClearBuffer(olc::Pixel p, bool bDepth) override
 		{
-#if defined(__APPLE__)
-			if (!mFullScreen) glutReshapeWindow(size.x, size.y);
-#else
-			glViewport(pos.x, pos.y, size.x, size.y);
-#endif
+			UNUSED(bDepth);
+			span::Fill(sprFrame->GetData(), sprFrame->width * sprFrame->height, p);
 		}
 	};
 }
-#endif
 // O------------------------------------------------------------------------------O
-// | END RENDERER: OpenGL 1.0 (the original, the best...)                         |
+// | END RENDERER: Software (offscreen, composites into an olc::Sprite)           |
 // O------------------------------------------------------------------------------O
 
 
@@ -3056,7 +6631,8 @@ namespace olc
 			if (!_gfs::exists(sImageFile)) return olc::rcode::NO_FILE;
 
 			// It does, so clear out existing sprite
-			if (spr->pColData != nullptr) delete[] spr->pColData;
+			if (spr->pColData != nullptr && spr->bOwnsData) delete[] spr->pColData;
+			spr->pColData = nullptr; spr->bOwnsData = true;
 
 			// Open file
 			UNUSED(pack);
@@ -3065,7 +6641,7 @@ namespace olc
 			{
 				// Load sprite from input stream
 				ResourceBuffer rb = pack->GetFileBuffer(sImageFile);
-				bmp = Gdiplus::Bitmap::FromStream(SHCreateMemStream((BYTE*)rb.vMemory.data(), UINT(rb.vMemory.size())));
+				bmp = Gdiplus::Bitmap::FromStream(SHCreateMemStream((const BYTE*)rb.pMemory, UINT(rb.nSize)));
 			}
 			else
 			{
@@ -3130,7 +6706,8 @@ namespace olc
 			if (!_gfs::exists(sImageFile)) return olc::rcode::NO_FILE;
 
 			// It does, so clear out existing sprite
-			if (spr->pColData != nullptr) delete[] spr->pColData;
+			if (spr->pColData != nullptr && spr->bOwnsData) delete[] spr->pColData;
+			spr->pColData = nullptr; spr->bOwnsData = true;
 			
 			
 			////////////////////////////////////////////////////////////////////////////
@@ -3262,7 +6839,8 @@ namespace olc
 			if (!_gfs::exists(sImageFile)) return olc::rcode::NO_FILE;
 
 			// It does, so clear out existing sprite
-			if (spr->pColData != nullptr) delete[] spr->pColData;
+			if (spr->pColData != nullptr && spr->bOwnsData) delete[] spr->pColData;
+			spr->pColData = nullptr; spr->bOwnsData = true;
 
 			// Open file
 			stbi_uc* bytes = nullptr;
@@ -3270,7 +6848,7 @@ namespace olc
 			if (pack != nullptr)
 			{
 				ResourceBuffer rb = pack->GetFileBuffer(sImageFile);
-				bytes = stbi_load_from_memory((unsigned char*)rb.vMemory.data(), rb.vMemory.size(), &w, &h, &cmp, 4);
+				bytes = stbi_load_from_memory((const unsigned char*)rb.pMemory, int(rb.nSize), &w, &h, &cmp, 4);
 			}
 			else
 			{
@@ -3300,7 +6878,7 @@ namespace olc
 // O------------------------------------------------------------------------------O
 // | START PLATFORM: MICROSOFT WINDOWS XP, VISTA, 7, 8, 10                        |
 // O------------------------------------------------------------------------------O
-#if defined(_WIN32)
+#if defined(_WIN32) && !defined(OLC_PLATFORM_HEADLESS)
 #if !defined(__MINGW32__)
 #pragma comment(lib, "user32.lib")		// Visual Studio Only
 #pragma comment(lib, "gdi32.lib")		// For other Windows Compilers please add
@@ -3472,6 +7050,8 @@ namespace olc
 		// Windows Event Handler - this is statically connected to the windows event system
 		static LRESULT CALLBACK olc_WindowEvent(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 		{
+			// Messages arrive on this thread, so release an idle engine thread
+			platform->WakeSystemEvent();
 			switch (uMsg)
 			{
 			case WM_MOUSEMOVE:
@@ -3514,7 +7094,9 @@ namespace olc
 // O------------------------------------------------------------------------------O
 // | START PLATFORM: LINUX                                                        |
 // O------------------------------------------------------------------------------O
-#if defined(__linux__) || defined(__FreeBSD__)
+#if (defined(__linux__) || defined(__FreeBSD__)) && !defined(OLC_PLATFORM_HEADLESS)
+#include <poll.h>
+#include <unistd.h>
 namespace olc
 {
 	class Platform_Linux : public olc::Platform
@@ -3526,13 +7108,26 @@ namespace olc
 		X11::XVisualInfo* olc_VisualInfo;
 		X11::Colormap                olc_ColourMap;
 		X11::XSetWindowAttributes    olc_SetWindowAttribs;
+		int                          olc_WakePipe[2] = { -1, -1 };
 
 	public:
 		virtual olc::rcode ApplicationStartUp() override
-		{ return olc::rcode::OK; }
+		{
+			// X11 events are read on the engine thread, so an idle engine waits on the
+			// display connection, and other threads wake it by writing to this pipe.
+			// It never blocks, it is only drained while idle and may fill up otherwise
+			if (pipe2(olc_WakePipe, O_NONBLOCK | O_CLOEXEC) != 0) return olc::rcode::FAIL;
+			return olc::rcode::OK;
+		}
 
 		virtual olc::rcode ApplicationCleanUp() override
-		{ return olc::rcode::OK; }
+		{
+			// Late wake ups must not write to whatever reuses the descriptors
+			close(olc_WakePipe[0]);
+			close(olc_WakePipe[1]);
+			olc_WakePipe[0] = -1; olc_WakePipe[1] = -1;
+			return olc::rcode::OK;
+		}
 
 		virtual olc::rcode ThreadStartUp() override
 		{ return olc::rcode::OK; }
@@ -3651,6 +7246,31 @@ namespace olc
 		virtual olc::rcode StartSystemEventLoop() override
 		{ return olc::OK; }
 
+		virtual olc::rcode WaitSystemEvent(float fTimeout) override
+		{
+			// Events may already have been read from the connection into Xlib's queue
+			if (X11::XPending(olc_Display) == 0)
+			{
+				pollfd fds[2] = { { X11::XConnectionNumber(olc_Display), POLLIN, 0 }, { olc_WakePipe[0], POLLIN, 0 } };
+				poll(fds, 2, int(fTimeout * 1000.0f));
+			}
+
+			// Drain any wake ups, they have served their purpose
+			char buffer[64];
+			while (read(olc_WakePipe[0], buffer, sizeof(buffer)) > 0) {}
+			return olc::OK;
+		}
+
+		virtual olc::rcode WakeSystemEvent() override
+		{
+			const int fd = olc_WakePipe[1];
+			if (fd == -1) return olc::OK;
+			// A full pipe already holds a wake up
+			const char c = 1;
+			if (write(fd, &c, 1) != 1 && errno != EAGAIN) return olc::FAIL;
+			return olc::OK;
+		}
+
 		virtual olc::rcode HandleSystemEvent() override
 		{
 			using namespace X11;
@@ -3749,7 +7369,7 @@ namespace olc
 // and support on how to setup your build environment.
 //
 // "MASSIVE MASSIVE THANKS TO MUMFLR" - Javidx9
-#if defined(__APPLE__)
+#if defined(__APPLE__) && !defined(OLC_PLATFORM_HEADLESS)
 namespace olc {
 
 	class Platform_GLUT : public olc::Platform
@@ -3996,6 +7616,106 @@ namespace olc {
 // O------------------------------------------------------------------------------O
 
 
+// O------------------------------------------------------------------------------O
+// | START PLATFORM: HEADLESS (no window, for tests and benchmarks)               |
+// O------------------------------------------------------------------------------O
+#if defined(OLC_PLATFORM_HEADLESS)
+namespace olc
+{
+	class Platform_Headless : public olc::Platform
+	{
+	private:
+		uint32_t nFrame = 0;
+		size_t nNextInput = 0;
+
+		void DumpFrame(uint32_t n)
+		{
+			const olc::HeadlessConfig& cfg = ptrPGE->GetHeadlessConfig();
+			const olc::Sprite* spr = ptrPGE->GetRenderedFrame();
+			if (cfg.sDumpPrefix.empty() || spr == nullptr || n % std::max(cfg.nDumpEvery, 1u) != 0) return;
+
+			// Zero padded, so the files list in frame order
+			std::string sFrame = std::to_string(n);
+			if (sFrame.size() < 5) sFrame.insert(0, 5 - sFrame.size(), '0');
+			const_cast<olc::Sprite*>(spr)->SaveToPGESprFile(cfg.sDumpPrefix + sFrame + ".spr");
+		}
+
+	public:
+		virtual olc::rcode ApplicationStartUp() override
+		{ return olc::rcode::OK; }
+
+		virtual olc::rcode ApplicationCleanUp() override
+		{ return olc::rcode::OK; }
+
+		virtual olc::rcode ThreadStartUp() override
+		{ return olc::rcode::OK; }
+
+		virtual olc::rcode ThreadCleanUp() override
+		{
+			// The last frame has not been seen by HandleSystemEvent()
+			if (nFrame > 0) DumpFrame(nFrame - 1);
+			renderer->DestroyDevice();
+			return olc::OK;
+		}
+
+		virtual olc::rcode CreateGraphics(bool bFullScreen, bool bEnableVSYNC, const olc::vi2d& vViewPos, const olc::vi2d& vViewSize) override
+		{
+			if (renderer->CreateDevice({}, bFullScreen, bEnableVSYNC) != olc::rcode::OK) return olc::rcode::FAIL;
+			renderer->UpdateViewport(vViewPos, vViewSize);
+			return olc::rcode::OK;
+		}
+
+		virtual olc::rcode CreateWindowPane(const olc::vi2d& vWindowPos, olc::vi2d& vWindowSize, bool bFullScreen) override
+		{
+			// There is no window, it keeps the requested size and always has focus
+			UNUSED(vWindowPos); UNUSED(vWindowSize); UNUSED(bFullScreen);
+			ptrPGE->olc_UpdateMouseFocus(true);
+			ptrPGE->olc_UpdateKeyFocus(true);
+			return olc::rcode::OK;
+		}
+
+		virtual olc::rcode SetWindowTitle(const std::string& s) override
+		{ UNUSED(s); return olc::rcode::OK; }
+
+		virtual olc::rcode StartSystemEventLoop() override
+		{ return olc::rcode::OK; }
+
+		virtual olc::rcode HandleSystemEvent() override
+		{
+			const olc::HeadlessConfig& cfg = ptrPGE->GetHeadlessConfig();
+
+			// The previous frame has been displayed by now
+			if (nFrame > 0) DumpFrame(nFrame - 1);
+
+			// Scripted input is in screen pixels, the engine expects window coordinates
+			const olc::vi2d& vPixel = ptrPGE->GetPixelSize();
+			for (; nNextInput < cfg.vecInput.size() && cfg.vecInput[nNextInput].nFrame <= nFrame; nNextInput++)
+			{
+				const olc::HeadlessInput& e = cfg.vecInput[nNextInput];
+				switch (e.type)
+				{
+				case olc::HeadlessInput::MOUSE_MOVE:  ptrPGE->olc_UpdateMouse(e.x * vPixel.x + vPixel.x / 2, e.y * vPixel.y + vPixel.y / 2); break;
+				case olc::HeadlessInput::MOUSE_DOWN:  ptrPGE->olc_UpdateMouseState(e.nCode, true); break;
+				case olc::HeadlessInput::MOUSE_UP:    ptrPGE->olc_UpdateMouseState(e.nCode, false); break;
+				case olc::HeadlessInput::MOUSE_WHEEL: ptrPGE->olc_UpdateMouseWheel(e.x); break;
+				case olc::HeadlessInput::KEY_DOWN:    ptrPGE->olc_UpdateKeyState(e.nCode, true); break;
+				case olc::HeadlessInput::KEY_UP:      ptrPGE->olc_UpdateKeyState(e.nCode, false); break;
+				}
+			}
+
+			// This frame is still updated and displayed, then the engine stops
+			if (cfg.nFrames > 0 && nFrame + 1 >= cfg.nFrames) ptrPGE->olc_Terminate();
+			nFrame++;
+			return olc::rcode::OK;
+		}
+	};
+}
+#endif
+// O------------------------------------------------------------------------------O
+// | END PLATFORM: HEADLESS                                                       |
+// O------------------------------------------------------------------------------O
+
+
 
 namespace olc
 {
@@ -4017,6 +7737,9 @@ namespace olc
 
 
 
+#if defined(OLC_PLATFORM_HEADLESS)
+		platform = std::make_unique<olc::Platform_Headless>();
+#else
 #if defined(_WIN32)
 		platform = std::make_unique<olc::Platform_Windows>();
 #endif
@@ -4028,25 +7751,46 @@ namespace olc
 #if defined(__APPLE__)
 		platform = std::make_unique<olc::Platform_GLUT>();
 #endif
+#endif
 
 
 
+		olc_SelectRenderer(olc::GfxBackend::DEFAULT);
+
+		// Associate components with PGE instance
+		platform->ptrPGE = this;
+	}
+
+	olc::rcode PixelGameEngine::olc_SelectRenderer(olc::GfxBackend backend)
+	{
+		std::unique_ptr<olc::Renderer> selected;
+
 #if defined(OLC_GFX_OPENGL10)
-		renderer = std::make_unique<olc::Renderer_OGL10>();
+		if (backend == olc::GfxBackend::DEFAULT || backend == olc::GfxBackend::OPENGL10)
+			selected = std::make_unique<olc::Renderer_OGL10>();
 #endif
 
 #if defined(OLC_GFX_OPENGL33)
-		renderer = std::make_unique<olc::Renderer_OGL33>();
+		if (backend == olc::GfxBackend::DEFAULT || backend == olc::GfxBackend::OPENGL33)
+			selected = std::make_unique<olc::Renderer_OGL33>();
 #endif
 
 #if defined(OLC_GFX_DIRECTX10)
-		renderer = std::make_unique<olc::Renderer_DX10>();
+		if (backend == olc::GfxBackend::DEFAULT || backend == olc::GfxBackend::DIRECTX10)
+			selected = std::make_unique<olc::Renderer_DX10>();
 #endif
 
-		// Associate components with PGE instance
-		platform->ptrPGE = this;
+		if (selected == nullptr && (backend == olc::GfxBackend::DEFAULT || backend == olc::GfxBackend::SOFTWARE))
+			selected = std::make_unique<olc::Renderer_Software>();
+
+		if (selected == nullptr) return olc::FAIL;
+		renderer = std::move(selected);
 		renderer->ptrPGE = this;
+		return olc::OK;
 	}
+
+	const olc::Sprite* PixelGameEngine::GetRenderedFrame() const
+	{ return renderer != nullptr ? renderer->GetFrame() : nullptr; }
 }
 
 #endif // End olc namespace